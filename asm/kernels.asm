@@ -0,0 +1,296 @@
+; Long arithmetic kernels for little-endian arrays of qwords, callable from C
+; through the System V AMD64 ABI, see kernels.h for the prototypes.
+; The result array may coincide with an operand but must not overlap it otherwise.
+
+                section         .text
+
+                global          bigint_add_n
+                global          bigint_sub_n
+                global          bigint_mul_1
+                global          bigint_addmul_1
+                global          bigint_addmul_1_adx
+                global          bigint_submul_1
+                global          bigint_divrem_1
+                global          bigint_lshift
+                global          bigint_rshift
+
+; adds two long numbers of the same length
+;    rdi -- address of sum (long number)
+;    rsi -- address of summand #1 (long number)
+;    rdx -- address of summand #2 (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- carry
+bigint_add_n:
+                xor             eax, eax
+                mov             r8, rcx
+                shr             rcx, 2
+                and             r8, 3
+                jz              .blocks
+.single:
+                mov             r9, [rsi]
+                adc             r9, [rdx]
+                mov             [rdi], r9
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .single
+.blocks:
+                jrcxz           .done
+.loop:
+                mov             r8, [rsi]
+                mov             r9, [rsi + 8]
+                mov             r10, [rsi + 16]
+                mov             r11, [rsi + 24]
+                adc             r8, [rdx]
+                adc             r9, [rdx + 8]
+                adc             r10, [rdx + 16]
+                adc             r11, [rdx + 24]
+                mov             [rdi], r8
+                mov             [rdi + 8], r9
+                mov             [rdi + 16], r10
+                mov             [rdi + 24], r11
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .loop
+.done:
+                setc            al
+                ret
+
+; subtracts two long numbers of the same length
+;    rdi -- address of difference (long number)
+;    rsi -- address of minuend (long number)
+;    rdx -- address of subtrahend (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- borrow
+bigint_sub_n:
+                xor             eax, eax
+                mov             r8, rcx
+                shr             rcx, 2
+                and             r8, 3
+                jz              .blocks
+.single:
+                mov             r9, [rsi]
+                sbb             r9, [rdx]
+                mov             [rdi], r9
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .single
+.blocks:
+                jrcxz           .done
+.loop:
+                mov             r8, [rsi]
+                mov             r9, [rsi + 8]
+                mov             r10, [rsi + 16]
+                mov             r11, [rsi + 24]
+                sbb             r8, [rdx]
+                sbb             r9, [rdx + 8]
+                sbb             r10, [rdx + 16]
+                sbb             r11, [rdx + 24]
+                mov             [rdi], r8
+                mov             [rdi + 8], r9
+                mov             [rdi + 16], r10
+                mov             [rdi + 24], r11
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .loop
+.done:
+                setc            al
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of product (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- the highest qword of the product
+bigint_mul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                mov             [rdi], rax
+                mov             r9, rdx
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .loop
+.done:
+                mov             rax, r9
+                ret
+
+; adds product of long number by a short to another long number
+;    rdi -- address of summand (long number), the sum is written there
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- carry qword
+bigint_addmul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                add             [rdi], rax
+                adc             rdx, 0
+                mov             r9, rdx
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .loop
+.done:
+                mov             rax, r9
+                ret
+
+; same as bigint_addmul_1, needs BMI2 and ADX: the carry of the previous high qword
+; and the carry of the summand are propagated in two independent chains through CF and OF
+bigint_addmul_1_adx:
+                mov             rax, rcx
+                mov             rcx, rdx
+                mov             rdx, rax
+                xor             r9d, r9d
+                jrcxz           .done
+.loop:
+                mulx            r11, r10, [rsi]
+                adcx            r10, r9
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mov             r9, r11
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx - 1]
+                jrcxz           .done
+                jmp             .loop
+.done:
+                mov             eax, 0
+                adcx            rax, r9
+                adox            rax, rcx
+                ret
+
+; subtracts product of long number by a short from another long number
+;    rdi -- address of minuend (long number), the difference is written there
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- borrow qword
+bigint_submul_1:
+                mov             r8, rdx
+                xor             r9d, r9d
+                test            r8, r8
+                jz              .done
+.loop:
+                mov             rax, [rsi]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                sub             [rdi], rax
+                adc             rdx, 0
+                mov             r9, rdx
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                dec             r8
+                jnz             .loop
+.done:
+                mov             rax, r9
+                ret
+
+; divides long number by a short
+;    rdi -- address of dividend (long number), the quotient is written there
+;    rsi -- length of long number in qwords
+;    rdx -- divisor (64-bit unsigned)
+; result:
+;    rax -- remainder
+bigint_divrem_1:
+                mov             r8, rdx
+                xor             edx, edx
+                test            rsi, rsi
+                jz              .done
+.loop:
+                mov             rax, [rdi + 8 * rsi - 8]
+                div             r8
+                mov             [rdi + 8 * rsi - 8], rax
+                dec             rsi
+                jnz             .loop
+.done:
+                mov             rax, rdx
+                ret
+
+; shifts long number to the left, from the highest qword down
+;    rdi -- address of result (long number)
+;    rsi -- address of argument (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- shift, 0 < rcx < 64
+; result:
+;    rax -- the bits shifted out in the lowest positions
+bigint_lshift:
+                xor             eax, eax
+                test            rdx, rdx
+                jz              .done
+                mov             r8, [rsi + 8 * rdx - 8]
+                shld            rax, r8, cl
+                dec             rdx
+                jz              .last
+.loop:
+                mov             r9, [rsi + 8 * rdx - 8]
+                shld            r8, r9, cl
+                mov             [rdi + 8 * rdx], r8
+                mov             r8, r9
+                dec             rdx
+                jnz             .loop
+.last:
+                shl             r8, cl
+                mov             [rdi], r8
+.done:
+                ret
+
+; shifts long number to the right, from the lowest qword up
+;    rdi -- address of result (long number)
+;    rsi -- address of argument (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- shift, 0 < rcx < 64
+; result:
+;    rax -- the bits shifted out in the highest positions
+bigint_rshift:
+                xor             eax, eax
+                test            rdx, rdx
+                jz              .done
+                mov             r8, [rsi]
+                shrd            rax, r8, cl
+                xor             r10d, r10d
+                dec             rdx
+                jz              .last
+.loop:
+                mov             r9, [rsi + 8 * r10 + 8]
+                shrd            r8, r9, cl
+                mov             [rdi + 8 * r10], r8
+                mov             r8, r9
+                inc             r10
+                dec             rdx
+                jnz             .loop
+.last:
+                shr             r8, cl
+                mov             [rdi + 8 * r10], r8
+.done:
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,42 @@
+#pragma once
+
+// Prototypes of the kernels from kernels.asm, numbers are little-endian arrays of n qwords.
+// The result may coincide with an operand but must not overlap it otherwise.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// r = a + b, returns the carry
+uint64_t bigint_add_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+
+// r = a - b, returns the borrow
+uint64_t bigint_sub_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+
+// r = a * b, returns the highest qword
+uint64_t bigint_mul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t b);
+
+// r += a * b, returns the highest qword
+uint64_t bigint_addmul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t b);
+
+// same as bigint_addmul_1, the processor must support BMI2 and ADX
+uint64_t bigint_addmul_1_adx(uint64_t* r, const uint64_t* a, size_t n, uint64_t b);
+
+// r -= a * b, returns the borrow out of the highest qword
+uint64_t bigint_submul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t b);
+
+// a /= d in place, returns the remainder
+uint64_t bigint_divrem_1(uint64_t* a, size_t n, uint64_t d);
+
+// r = a << cnt, 0 < cnt < 64, returns the bits shifted out
+uint64_t bigint_lshift(uint64_t* r, const uint64_t* a, size_t n, size_t cnt);
+
+// r = a >> cnt, 0 < cnt < 64, returns the bits shifted out in the highest positions
+uint64_t bigint_rshift(uint64_t* r, const uint64_t* a, size_t n, size_t cnt);
+
+#ifdef __cplusplus
+}
+#endif
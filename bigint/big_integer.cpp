@@ -1,64 +1,200 @@
 #include "big_integer.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <istream>
 #include <limits>
 #include <ostream>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <vector>
 
-static const big_integer::digit MAX_DIGIT = std::numeric_limits<big_integer::digit>::max();
-static const uint64_t BASE = static_cast<uint64_t>(MAX_DIGIT) + 1;
-static const size_t DIGIT_LEN = std::numeric_limits<big_integer::digit>::digits;
+#if defined(BIGINT_64BIT_DIGITS) && defined(__x86_64__)
+#include <immintrin.h>
+#define BIGINT_X86_64_INTRINSICS
+#endif
+
+// kernels for newer instruction sets are compiled for them by target attributes and chosen at run time
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BIGINT_X86_64_DISPATCH
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef BIGINT_ASM_KERNELS
+#include "kernels.h"
+#endif
+
+#include "thread_pool.h"
+
+#ifdef BIGINT_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace {
+using digit = big_integer::digit;
+using digit_vector = big_integer::digit_vector;
+// holds the full product of two digits
+#ifdef BIGINT_64BIT_DIGITS
+__extension__ typedef unsigned __int128 double_digit;
+#else
+using double_digit = uint64_t;
+#endif
+} // namespace
+
+static const digit MAX_DIGIT = std::numeric_limits<digit>::max();
+static const size_t DIGIT_LEN = std::numeric_limits<digit>::digits;
+
+static const size_t DEC_DIGIT_LEN = std::numeric_limits<digit>::digits10;
+static const auto POW10 = [] {
+  std::array<digit, DEC_DIGIT_LEN + 1> pow{1};
+  for (size_t i = 1; i < pow.size(); ++i) {
+    pow[i] = pow[i - 1] * 10;
+  }
+  return pow;
+}();
+static const digit DEC_BASE = POW10[DEC_DIGIT_LEN];
+
+#ifdef BIGINT_INSTRUMENTATION
+namespace {
+using statistics = big_integer_statistics;
+
+struct shared_counters {
+  std::atomic<uint64_t> calls;
+  std::atomic<uint64_t> nanoseconds;
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> shrinks;
+  std::array<std::atomic<uint64_t>, statistics::SIZE_BUCKETS> lhs_sizes;
+  std::array<std::atomic<uint64_t>, statistics::SIZE_BUCKETS> rhs_sizes;
+};
+
+std::array<shared_counters, statistics::COUNT> shared_statistics;
+// probes alive on this thread, only the outermost one counts
+thread_local size_t probe_depth = 0;
+// normalizations on this thread that dropped digits
+thread_local uint64_t shrink_count = 0;
+
+void bump(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+size_t size_bucket(size_t size) {
+  return std::min<size_t>(std::bit_width(size), statistics::SIZE_BUCKETS - 1);
+}
+
+// counts an entry point from construction to destruction
+class probe {
+public:
+  probe(statistics::operation op, size_t lhs_size, size_t rhs_size) noexcept {
+    if (probe_depth++ != 0) {
+      return;
+    }
+    _counters = &shared_statistics[op];
+    bump(_counters->calls);
+    bump(_counters->lhs_sizes[size_bucket(lhs_size)]);
+    bump(_counters->rhs_sizes[size_bucket(rhs_size)]);
+    _allocations = small_vector_allocations;
+    _shrinks = shrink_count;
+    _start = std::chrono::steady_clock::now();
+  }
+
+  probe(const probe&) = delete;
+  probe& operator=(const probe&) = delete;
 
-static const uint32_t POW10[]{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+  ~probe() {
+    --probe_depth;
+    if (_counters) {
+      auto elapsed = std::chrono::steady_clock::now() - _start;
+      bump(_counters->nanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      bump(_counters->allocations, small_vector_allocations - _allocations);
+      bump(_counters->shrinks, shrink_count - _shrinks);
+    }
+  }
+
+private:
+  shared_counters* _counters = nullptr;
+  size_t _allocations = 0;
+  uint64_t _shrinks = 0;
+  std::chrono::steady_clock::time_point _start;
+};
+} // namespace
+
+#define BIGINT_PROBE(op, lhs_size, rhs_size) probe op_probe(statistics::op, lhs_size, rhs_size)
+
+big_integer_statistics big_integer_statistics_snapshot() {
+  big_integer_statistics res;
+  for (size_t op = 0; op < statistics::COUNT; ++op) {
+    const shared_counters& from = shared_statistics[op];
+    statistics::counters& to = res.operations[op];
+    to.calls = from.calls.load(std::memory_order_relaxed);
+    to.nanoseconds = from.nanoseconds.load(std::memory_order_relaxed);
+    to.allocations = from.allocations.load(std::memory_order_relaxed);
+    to.shrinks = from.shrinks.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < statistics::SIZE_BUCKETS; ++i) {
+      to.lhs_sizes[i] = from.lhs_sizes[i].load(std::memory_order_relaxed);
+      to.rhs_sizes[i] = from.rhs_sizes[i].load(std::memory_order_relaxed);
+    }
+  }
+  return res;
+}
 
-static const size_t DEC_DIGIT_LEN = std::numeric_limits<big_integer::digit>::digits10;
-static const big_integer::digit DEC_BASE = POW10[DEC_DIGIT_LEN];
+void reset_big_integer_statistics() {
+  for (shared_counters& counters : shared_statistics) {
+    counters.calls = 0;
+    counters.nanoseconds = 0;
+    counters.allocations = 0;
+    counters.shrinks = 0;
+    for (size_t i = 0; i < statistics::SIZE_BUCKETS; ++i) {
+      counters.lhs_sizes[i] = 0;
+      counters.rhs_sizes[i] = 0;
+    }
+  }
+}
+#else
+#define BIGINT_PROBE(op, lhs_size, rhs_size)
+#endif
 
 big_integer::big_integer() noexcept = default;
 
 big_integer::big_integer(const big_integer& other) = default;
 
+big_integer::big_integer(big_integer&& other) noexcept
+    : data(std::move(other.data)), sign(std::exchange(other.sign, false)) {
+  other.data.clear();
+}
+
 big_integer::big_integer(unsigned long long a, bool sign) : sign(sign) {
   data.reserve(UINT64_WIDTH / DIGIT_LEN);
   while (a != 0) {
-    data.push_back(a & MAX_DIGIT);
-    a >>= DIGIT_LEN;
+    data.push_back(static_cast<digit>(a));
+    a = static_cast<unsigned long long>(static_cast<double_digit>(a) >> DIGIT_LEN);
   }
 }
 
-big_integer::big_integer(const std::string& str) {
-  bool _sign = str.starts_with("-");
-  size_t begin = str.starts_with("+") || str.starts_with("-") ? 1 : 0;
-  if (begin == str.size()) {
-    throw std::invalid_argument("number expected at position" + std::to_string(begin));
-  }
-  for (; begin < str.size(); begin += DEC_DIGIT_LEN) {
-    std::string val = str.substr(begin, DEC_DIGIT_LEN);
-    if (val.starts_with("+") || val.starts_with("-") || isspace(val[0])) {
-      throw std::invalid_argument("no signs or spaces expected at position " + std::to_string(begin));
-    }
-    multiply_digit(POW10[val.size()]);
-    size_t pos = 0;
-    add_digit(std::stoi(val, &pos));
-    if (pos != val.size()) {
-      throw std::invalid_argument("unknown symbols found at position " + std::to_string(begin + pos));
-    }
-  }
-  shrink();
-  sign = _sign;
-}
-
 big_integer::~big_integer() = default;
 
 big_integer& big_integer::operator=(const big_integer& other) {
   if (this != &other) {
-    big_integer copy(other);
-    swap(*this, copy);
+    data = other.data;
+    sign = other.sign;
+  }
+  return *this;
+}
+
+big_integer& big_integer::operator=(big_integer&& other) {
+  if (this != &other) {
+    data = std::move(other.data);
+    sign = std::exchange(other.sign, false);
+    other.data.clear();
   }
   return *this;
 }
@@ -71,11 +207,11 @@ bool unsigned_less(const big_integer& a, const big_integer& b) {
 }
 
 void add_iterative(big_integer::digit& lhs, big_integer::digit rhs, bool& carry) {
-  uint64_t new_val = lhs;
+  double_digit new_val = lhs;
   new_val += rhs;
   new_val += carry;
-  carry = new_val >> DIGIT_LEN;
-  lhs = new_val & MAX_DIGIT;
+  carry = static_cast<bool>(new_val >> DIGIT_LEN);
+  lhs = static_cast<big_integer::digit>(new_val);
 }
 
 void big_integer::add_unsigned(const big_integer& rhs) {
@@ -111,7 +247,7 @@ void subtract_iterative(big_integer::digit& lhs, big_integer::digit rhs, bool& b
 }
 
 void big_integer::subtract_unsigned(const big_integer& rhs) {
-  difference(rhs, 0, data.size() - 1);
+  difference(rhs, 0, std::max(data.size(), rhs.data.size()) - 1);
 }
 
 void big_integer::subtract_digit(digit rhs) {
@@ -152,6 +288,7 @@ void big_integer::difference(const big_integer& rhs, size_t k, size_t m) {
 }
 
 big_integer& big_integer::operator+=(const big_integer& rhs) {
+  BIGINT_PROBE(ADD, data.size(), rhs.data.size());
   if (sign == rhs.sign) {
     add_unsigned(rhs);
   } else {
@@ -161,6 +298,7 @@ big_integer& big_integer::operator+=(const big_integer& rhs) {
 }
 
 big_integer& big_integer::operator-=(const big_integer& rhs) {
+  BIGINT_PROBE(SUB, data.size(), rhs.data.size());
   negate();
   *this += rhs;
   negate();
@@ -169,12 +307,12 @@ big_integer& big_integer::operator-=(const big_integer& rhs) {
 
 void multiply_iteratively(big_integer::digit& result, big_integer::digit lhs, big_integer::digit rhs,
                           big_integer::digit& carry) {
-  uint64_t new_v = lhs;
+  double_digit new_v = lhs;
   new_v *= rhs;
   new_v += result;
   new_v += carry;
-  result = new_v & MAX_DIGIT;
-  carry = new_v >> DIGIT_LEN;
+  result = static_cast<big_integer::digit>(new_v);
+  carry = static_cast<big_integer::digit>(new_v >> DIGIT_LEN);
 }
 
 void big_integer::multiply_digit(digit rhs) {
@@ -188,378 +326,3393 @@ void big_integer::multiply_digit(digit rhs) {
   shrink();
 }
 
-big_integer& big_integer::operator*=(const big_integer& rhs) {
-  size_t old_size = data.size();
-  resize(data.size() + rhs.data.size());
-  for (size_t l = old_size; l--;) {
-    digit d = data[l];
-    data[l] = 0;
-    digit carry = 0;
-    for (size_t r = 0; r < rhs.data.size() || carry; ++r) {
-      multiply_iteratively(data.at(l + r), rhs.get(r), d, carry);
-    }
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 300
+#endif
+
+// The transform length is the next power of two, so its time doubles in steps; just above a step Toom-3 is
+// ahead up to about 9000 digits, from there on the transform is. With 64-bit digits the transform works on
+// two coefficients per digit while the other tiers get about three times faster, which moves the crossover
+// far up.
+#ifndef BIGINT_NTT_THRESHOLD
+#ifdef BIGINT_64BIT_DIGITS
+#define BIGINT_NTT_THRESHOLD 30000
+#else
+#define BIGINT_NTT_THRESHOLD 9000
+#endif
+#endif
+
+#ifndef BIGINT_DC_DIV_THRESHOLD
+#define BIGINT_DC_DIV_THRESHOLD 80
+#endif
+
+#ifndef BIGINT_TO_STRING_THRESHOLD
+#define BIGINT_TO_STRING_THRESHOLD 30
+#endif
+
+#ifndef BIGINT_FROM_STRING_THRESHOLD
+#define BIGINT_FROM_STRING_THRESHOLD 30
+#endif
+
+#ifndef BIGINT_SQR_KARATSUBA_THRESHOLD
+#define BIGINT_SQR_KARATSUBA_THRESHOLD 48
+#endif
+
+#ifndef BIGINT_SQR_TOOM3_THRESHOLD
+#define BIGINT_SQR_TOOM3_THRESHOLD 400
+#endif
+
+#ifndef BIGINT_SQR_NTT_THRESHOLD
+#ifdef BIGINT_64BIT_DIGITS
+#define BIGINT_SQR_NTT_THRESHOLD 30000
+#else
+#define BIGINT_SQR_NTT_THRESHOLD 10000
+#endif
+#endif
+
+#ifndef BIGINT_DIVREM_1_PREINV_THRESHOLD
+#define BIGINT_DIVREM_1_PREINV_THRESHOLD 4
+#endif
+
+#ifndef BIGINT_HGCD_THRESHOLD
+#define BIGINT_HGCD_THRESHOLD 100
+#endif
+
+#ifndef BIGINT_PARALLEL_THRESHOLD
+#ifdef BIGINT_64BIT_DIGITS
+#define BIGINT_PARALLEL_THRESHOLD 1000
+#else
+#define BIGINT_PARALLEL_THRESHOLD 2000
+#endif
+#endif
+
+namespace {
+// operands shorter than these (in digits) are multiplied by the previous tier
+const size_t KARATSUBA_THRESHOLD = BIGINT_KARATSUBA_THRESHOLD;
+const size_t TOOM3_THRESHOLD = BIGINT_TOOM3_THRESHOLD;
+const size_t NTT_THRESHOLD = BIGINT_NTT_THRESHOLD;
+const size_t SQR_KARATSUBA_THRESHOLD = BIGINT_SQR_KARATSUBA_THRESHOLD;
+const size_t SQR_TOOM3_THRESHOLD = BIGINT_SQR_TOOM3_THRESHOLD;
+const size_t SQR_NTT_THRESHOLD = BIGINT_SQR_NTT_THRESHOLD;
+// divisors shorter than this are handled by schoolbook division only
+const size_t DC_DIV_THRESHOLD = BIGINT_DC_DIV_THRESHOLD;
+// numbers shorter than these (in digits) are converted to and from decimal digit by digit
+const size_t TO_STRING_THRESHOLD = BIGINT_TO_STRING_THRESHOLD;
+const size_t FROM_STRING_THRESHOLD = BIGINT_FROM_STRING_THRESHOLD;
+// division by a single digit precomputes its reciprocal for dividends of at least this many digits
+const size_t DIVREM_1_PREINV_THRESHOLD = BIGINT_DIVREM_1_PREINV_THRESHOLD;
+// gcd reduces pairs of at least this many digits by the half gcd of their top digits
+const size_t HGCD_THRESHOLD = BIGINT_HGCD_THRESHOLD;
+// with a parallel scope, products and conversions of at least this many digits (or transforms of as many
+// coefficients) are split into tasks
+const size_t PARALLEL_THRESHOLD = BIGINT_PARALLEL_THRESHOLD;
+
+static_assert(KARATSUBA_THRESHOLD >= 2 && SQR_KARATSUBA_THRESHOLD >= 2, "karatsuba needs at least two digits");
+static_assert(DC_DIV_THRESHOLD >= 4, "recursive division needs at least two-digit halves");
+static_assert(TO_STRING_THRESHOLD >= 4, "radix conversion splits by powers of at least two digits");
+static_assert(TOOM3_THRESHOLD >= 9 && SQR_TOOM3_THRESHOLD >= 9, "toom-3 needs three non-empty parts");
+static_assert(HGCD_THRESHOLD >= 4, "half gcd recursion needs halves of at least two digits");
+static_assert(PARALLEL_THRESHOLD >= 2, "parallel transforms split halves of at least one butterfly");
+
+// pool of the innermost big_integer_parallel_scope on this thread
+thread_local thread_pool* parallel_pool = nullptr;
+
+bool parallel(size_t n) {
+  return n >= PARALLEL_THRESHOLD && parallel_pool != nullptr && parallel_pool->size() > 0;
+}
+
+// runs the functions as tasks of the current pool, the pool and the memory resource stay current inside them
+template <typename... F>
+void fork(F&&... f) {
+  thread_pool* pool = parallel_pool;
+  std::pmr::memory_resource* resource = small_vector_resource;
+  pool->invoke([pool, resource, &f] {
+    big_integer_parallel_scope parallel_scope(pool);
+    big_integer_memory_scope memory_scope(resource);
+    f();
+  }...);
+}
+
+// calls f(lo, hi) on pieces of [0, n), spread over the pool for long ranges
+template <typename F>
+void for_range(size_t n, const F& f) {
+  if (parallel(n)) {
+    parallel_pool->parallel_for(0, n, std::max(PARALLEL_THRESHOLD, n / (4 * parallel_pool->size())), f);
+  } else {
+    f(0, n);
   }
-  sign ^= rhs.sign;
-  shrink();
-  return *this;
 }
 
-big_integer::digit big_integer::to_digit() const {
-  return get(0);
-}
+#ifdef BIGINT_X86_64_DISPATCH
+struct cpu_features {
+  bool ssse3 = false;
+  bool avx2 = false;
+};
 
-big_integer::digit big_integer::div_digit(digit rhs) {
-  assert(rhs != 0);
-  uint64_t reminder = 0;
-  for (auto it = data.rbegin(); it != data.rend(); ++it) {
-    reminder <<= DIGIT_LEN;
-    reminder += *it;
-    *it = (reminder / rhs);
-    reminder %= rhs;
-  }
-  shrink();
-  return reminder;
+// BIGINT_KERNELS=generic in the environment keeps the portable kernels, e.g. for comparison
+bool portable_kernels_requested() {
+  const char* choice = std::getenv("BIGINT_KERNELS");
+  return choice != nullptr && std::strcmp(choice, "generic") == 0;
 }
 
-big_integer::digit trial(const big_integer& r, const big_integer& d, size_t k, size_t m) {
-  size_t km = k + m;
-  big_integer r3;
-  r3.data = {r.get(km - 2), r.get(km - 1), r.get(km)};
-  r3.shrink();
-  big_integer d2;
-  d2.data = {d.get(m - 2), d.get(m - 1)};
-  d2.shrink();
-
-  big_integer::digit left = 0;
-  big_integer::digit right = MAX_DIGIT;
-  while (right != left) {
-    big_integer::digit mid = (right - left) / 2 + (right - left) % 2 + left;
-    big_integer prod = d2;
-    prod.multiply_digit(mid);
-    if (unsigned_less(r3, prod)) {
-      right = mid - 1;
-    } else {
-      left = mid;
+// the features of the processor that kernels are chosen by, checked on the first call
+const cpu_features& cpu() {
+  static const cpu_features features = [] {
+    cpu_features res;
+    if (!portable_kernels_requested()) {
+      __builtin_cpu_init();
+      res.ssse3 = __builtin_cpu_supports("ssse3");
+      res.avx2 = __builtin_cpu_supports("avx2");
     }
+    return res;
+  }();
+  return features;
+}
+#endif
+
+// returns a + b + carry, carry (0 or 1) is replaced with the carry out
+inline digit add_carry(digit a, digit b, digit& carry) {
+#ifdef BIGINT_X86_64_INTRINSICS
+  unsigned long long sum;
+  carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &sum);
+  return sum;
+#else
+  double_digit sum = static_cast<double_digit>(a) + b + carry;
+  carry = static_cast<digit>(sum >> DIGIT_LEN);
+  return static_cast<digit>(sum);
+#endif
+}
+
+// returns a - b - borrow, borrow (0 or 1) is replaced with the borrow out
+inline digit sub_borrow(digit a, digit b, digit& borrow) {
+#ifdef BIGINT_X86_64_INTRINSICS
+  unsigned long long diff;
+  borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &diff);
+  return diff;
+#else
+  digit diff = a - b - borrow;
+  borrow = a < b || (a == b && borrow);
+  return diff;
+#endif
+}
+
+// returns the low digit of a * b, the high one is written to high
+inline digit mul_wide(digit a, digit b, digit& high) {
+#if defined(BIGINT_X86_64_INTRINSICS) && defined(__BMI2__)
+  unsigned long long prod_high;
+  digit prod_low = _mulx_u64(a, b, &prod_high);
+  high = prod_high;
+  return prod_low;
+#else
+  double_digit prod = static_cast<double_digit>(a) * b;
+  high = static_cast<digit>(prod >> DIGIT_LEN);
+  return static_cast<digit>(prod);
+#endif
+}
+
+// floor((BASE^2 - 1) / d) - BASE for a normalized d (the highest bit set), the reciprocal that turns
+// division by d into multiplications, see div_2by1
+constexpr digit reciprocal_of(digit d) {
+  return static_cast<digit>(((static_cast<double_digit>(~d) << DIGIT_LEN) | MAX_DIGIT) / d);
+}
+
+// Möller and Granlund's division by a normalized d with v = reciprocal_of(d): returns the quotient of
+// u1 * BASE + u0 for u1 < d and replaces u1 with the remainder. The estimate from v is off by at most one.
+inline digit div_2by1(digit& u1, digit u0, digit d, digit v) {
+  digit q1;
+  digit q0 = mul_wide(v, u1, q1);
+  q0 += u0;
+  q1 += u1 + 1 + (q0 < u0);
+  digit r = u0 - q1 * d;
+  if (r > q0) {
+    --q1;
+    r += d;
+  }
+  if (r >= d) {
+    ++q1;
+    r -= d;
   }
-  return left;
+  u1 = r;
+  return q1;
 }
 
-std::pair<big_integer, big_integer> unsigned_div(const big_integer& x, const big_integer& y, size_t m) {
-  big_integer::digit f = BASE / (static_cast<uint64_t>(y.get(m - 1)) + 1);
-  big_integer r = x;
-  r.multiply_digit(f);
-  big_integer d = y;
-  d.multiply_digit(f);
-  big_integer q = 0;
-  q.data.reserve(r.data.size() - m + 1);
-  for (size_t k = r.data.size() - m + 1; k > 0;) {
-    --k;
-    big_integer::digit qt = trial(r, d, k, m);
-    big_integer dq = d;
-    dq.multiply_digit(qt);
-    if (m + 1 <= dq.data.size() &&
-        std::lexicographical_compare(r.data.crbegin(), r.data.crbegin() + m + 1, dq.data.crbegin(), dq.data.crend())) {
-      --qt;
-      dq -= d;
-    }
-    q.data.push_back(qt);
-    r.difference(dq, k, m);
+// Low level routines below work on raw little-endian digit arrays, `r` may alias `a` or `b`
+// as long as it starts at the same position.
+
+// r[0, n) = a[0, n) + b[0, n), returns carry
+digit add_n_generic(digit* r, const digit* a, const digit* b, size_t n) {
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = add_carry(a[i], b[i], carry);
   }
-  std::reverse(q.data.begin(), q.data.end());
-  q.shrink();
-  r.div_digit(f);
-  return {q, r};
+  return carry;
 }
 
-std::pair<big_integer, big_integer> div(const big_integer& x, const big_integer& y) {
-  assert(!y.is_zero());
-  size_t m = y.data.size();
-  std::pair<big_integer, big_integer> res;
-  if (m == 1) {
-    big_integer::digit y1 = y.to_digit();
-    big_integer division = x;
-    big_integer reminder = division.div_digit(y1);
-    res = {division, reminder};
-  } else {
-    if (m > x.data.size()) {
-      res = {0, x};
-    } else {
-      res = unsigned_div(x, y, m);
-    }
+// r[0, n) = a[0, n) - b[0, n), returns borrow
+digit sub_n_generic(digit* r, const digit* a, const digit* b, size_t n) {
+  digit borrow = 0;
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = sub_borrow(a[i], b[i], borrow);
   }
-  res.first.sign = x.sign ^ y.sign;
-  res.second.sign = x.sign;
-  return res;
+  return borrow;
 }
 
-big_integer& big_integer::operator/=(const big_integer& rhs) {
-  auto div_mod_res = div(*this, rhs);
-  swap(*this, div_mod_res.first);
-  return *this;
+// r[0, n) = a[0, n) * b, returns the highest digit
+digit mul_1_generic(digit* r, const digit* a, size_t n, digit b) {
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    digit high;
+    digit low = mul_wide(a[i], b, high);
+    r[i] = low + carry;
+    carry = high + (r[i] < low);
+  }
+  return carry;
 }
 
-big_integer& big_integer::operator%=(const big_integer& rhs) {
-  auto div_mod_res = div(*this, rhs);
-  swap(*this, div_mod_res.second);
-  return *this;
+// r[0, n) += a[0, n) * b, returns the highest digit
+digit addmul_1_generic(digit* r, const digit* a, size_t n, digit b) {
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    digit high;
+    digit low = mul_wide(a[i], b, high);
+    low += carry;
+    high += low < carry;
+    r[i] += low;
+    carry = high + (r[i] < low);
+  }
+  return carry;
 }
 
-big_integer::digit true_signed(big_integer::digit data, bool sign, bool& carry) {
-  if (sign) {
-    data = ~data;
+// r[0, n) -= a[0, n) * b, returns the borrow out of r[n - 1]
+digit submul_1_generic(digit* r, const digit* a, size_t n, digit b) {
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    digit high;
+    digit low = mul_wide(a[i], b, high);
+    low += carry;
+    carry = high + (low < carry) + (r[i] < low);
+    r[i] -= low;
   }
-  data += carry;
-  carry = !data && carry;
-  return data;
+  return carry;
 }
 
-template <class BinaryOperation>
-big_integer& big_integer::binary(const big_integer& rhs, const BinaryOperation& op) {
-  size_t len = std::max(data.size(), rhs.data.size());
-  resize(len);
-  bool res_sign = op(sign, rhs.sign);
-  bool carry = sign, rcarry = rhs.sign, res_carry = res_sign;
-  for (size_t i = 0; i < len; i++) {
-    data[i] = true_signed(op(true_signed(get(i), sign, carry), true_signed(rhs.get(i), rhs.sign, rcarry)), res_sign,
-                          res_carry);
+// divides a[0, n) by d in place, returns the remainder
+digit divrem_1_generic(digit* a, size_t n, digit d) {
+  double_digit rem = 0;
+  for (size_t i = n; i-- > 0;) {
+    double_digit cur = (rem << DIGIT_LEN) | a[i];
+    a[i] = static_cast<digit>(cur / d);
+    rem = cur % d;
   }
-  sign = res_sign;
-  shrink();
-  return *this;
+  return static_cast<digit>(rem);
 }
 
-big_integer& big_integer::operator&=(const big_integer& rhs) {
-  return binary(rhs, std::bit_and<>());
-}
+// The shifts and the bitwise operations go through SSE2 registers, SIMD_WIDTH digits at a time, or through AVX2
+// ones on processors that have it, and a digit at a time on targets without SSE2.
+#if defined(__SSE2__)
+#define BIGINT_SIMD
+using simd = __m128i;
 
-big_integer& big_integer::operator|=(const big_integer& rhs) {
-  return binary(rhs, std::bit_or<>());
+inline simd simd_load(const digit* p) {
+  return _mm_loadu_si128(reinterpret_cast<const simd*>(p));
 }
 
-big_integer& big_integer::operator^=(const big_integer& rhs) {
-  return binary(rhs, std::bit_xor<>());
+inline void simd_store(digit* p, simd v) {
+  _mm_storeu_si128(reinterpret_cast<simd*>(p), v);
 }
 
-big_integer& big_integer::operator<<=(int rhs) {
-  assert(rhs >= 0);
-  data.reserve(data.size() + (rhs + DIGIT_LEN - 1) / DIGIT_LEN);
-  data.insert(data.begin(), rhs / DIGIT_LEN, 0);
-  rhs %= DIGIT_LEN;
-  if (rhs) {
-    digit rest = 0;
-    for (auto& val : data) {
-      digit new_rest = val >> (DIGIT_LEN - rhs);
-      val = (val << rhs) | rest;
-      rest = new_rest;
-    }
-    if (rest) {
-      data.push_back(rest);
-    }
-  }
-  return *this;
+inline simd simd_fill(digit d) {
+  return sizeof(digit) == 8 ? _mm_set1_epi64x(static_cast<long long>(d)) : _mm_set1_epi32(static_cast<int>(d));
 }
 
-big_integer& big_integer::operator>>=(int rhs) {
-  assert(rhs >= 0);
-  bool round = false;
-  auto del_end = data.begin() + std::min(data.size(), static_cast<size_t>(rhs / DIGIT_LEN));
-  for (auto it2 = data.begin(); it2 != del_end && !round; ++it2) {
-    round |= *it2;
-  }
-  data.erase(data.begin(), del_end);
-  rhs %= DIGIT_LEN;
-  if (rhs) {
-    digit rest = 0;
-    for (auto it = data.rbegin(); it != data.rend(); it++) {
-      digit new_rest = *it << (DIGIT_LEN - rhs);
-      *it = (*it >> rhs) | rest;
-      rest = new_rest;
-    }
-    round |= rest;
-  }
-  if (this->is_negative() && round) {
-    --(*this);
-  }
-  shrink();
-  return *this;
+inline simd simd_shl(simd v, size_t cnt) {
+  __m128i c = _mm_cvtsi32_si128(static_cast<int>(cnt));
+  return sizeof(digit) == 8 ? _mm_sll_epi64(v, c) : _mm_sll_epi32(v, c);
 }
 
-big_integer big_integer::operator+() const {
-  return *this;
+inline simd simd_shr(simd v, size_t cnt) {
+  __m128i c = _mm_cvtsi32_si128(static_cast<int>(cnt));
+  return sizeof(digit) == 8 ? _mm_srl_epi64(v, c) : _mm_srl_epi32(v, c);
 }
 
-big_integer big_integer::operator-() const {
-  big_integer tmp = *this;
-  tmp.negate();
-  return tmp;
+inline simd simd_apply(std::bit_and<>, simd a, simd b) {
+  return _mm_and_si128(a, b);
 }
 
-big_integer big_integer::operator~() const {
-  big_integer tmp = *this;
-  ++tmp;
-  tmp.negate();
-  return tmp;
+inline simd simd_apply(std::bit_or<>, simd a, simd b) {
+  return _mm_or_si128(a, b);
 }
 
-big_integer& big_integer::operator++() {
-  if (sign) {
-    subtract_digit(1);
-  } else {
-    add_digit(1);
-  }
-  return *this;
+inline simd simd_apply(std::bit_xor<>, simd a, simd b) {
+  return _mm_xor_si128(a, b);
 }
+#endif
 
-big_integer big_integer::operator++(int) {
-  big_integer tmp = *this;
-  ++(*this);
-  return tmp;
+#ifdef BIGINT_SIMD
+constexpr size_t SIMD_WIDTH = sizeof(simd) / sizeof(digit);
+#endif
+
+#ifdef BIGINT_X86_64_DISPATCH
+// The vector loops of the kernels below with 256-bit registers, compiled for AVX2 whatever the target and
+// called only when the processor has it. They return the position the loops of the kernels go on from.
+constexpr size_t AVX2_WIDTH = sizeof(__m256i) / sizeof(digit);
+
+[[gnu::target("avx2")]] inline __m256i avx2_load(const digit* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
 }
 
-big_integer& big_integer::operator--() {
-  negate();
-  ++(*this);
-  negate();
-  return *this;
+[[gnu::target("avx2")]] inline void avx2_store(digit* p, __m256i v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
 }
 
-big_integer big_integer::operator--(int) {
-  big_integer tmp = *this;
-  --(*this);
-  return tmp;
+[[gnu::target("avx2")]] inline __m256i avx2_fill(digit d) {
+  return sizeof(digit) == 8 ? _mm256_set1_epi64x(static_cast<long long>(d)) : _mm256_set1_epi32(static_cast<int>(d));
 }
 
-big_integer operator+(const big_integer& a, const big_integer& b) {
-  return big_integer(a) += b;
+[[gnu::target("avx2")]] inline __m256i avx2_shl(__m256i v, size_t cnt) {
+  __m128i c = _mm_cvtsi32_si128(static_cast<int>(cnt));
+  return sizeof(digit) == 8 ? _mm256_sll_epi64(v, c) : _mm256_sll_epi32(v, c);
 }
 
-big_integer operator-(const big_integer& a, const big_integer& b) {
-  return big_integer(a) -= b;
+[[gnu::target("avx2")]] inline __m256i avx2_shr(__m256i v, size_t cnt) {
+  __m128i c = _mm_cvtsi32_si128(static_cast<int>(cnt));
+  return sizeof(digit) == 8 ? _mm256_srl_epi64(v, c) : _mm256_srl_epi32(v, c);
 }
 
-big_integer operator*(const big_integer& a, const big_integer& b) {
-  return big_integer(a) *= b;
+[[gnu::target("avx2")]] inline __m256i avx2_apply(std::bit_and<>, __m256i a, __m256i b) {
+  return _mm256_and_si256(a, b);
 }
 
-big_integer operator/(const big_integer& a, const big_integer& b) {
-  return big_integer(a) /= b;
+[[gnu::target("avx2")]] inline __m256i avx2_apply(std::bit_or<>, __m256i a, __m256i b) {
+  return _mm256_or_si256(a, b);
 }
 
-big_integer operator%(const big_integer& a, const big_integer& b) {
-  return big_integer(a) %= b;
+[[gnu::target("avx2")]] inline __m256i avx2_apply(std::bit_xor<>, __m256i a, __m256i b) {
+  return _mm256_xor_si256(a, b);
 }
 
-big_integer operator&(const big_integer& a, const big_integer& b) {
-  return big_integer(a) &= b;
+[[gnu::target("avx2")]] size_t lshift_avx2(digit* r, const digit* a, size_t i, size_t cnt) {
+  for (; i > AVX2_WIDTH; i -= AVX2_WIDTH) {
+    __m256i high = avx2_shl(avx2_load(a + i - AVX2_WIDTH), cnt);
+    __m256i low = avx2_shr(avx2_load(a + i - AVX2_WIDTH - 1), DIGIT_LEN - cnt);
+    avx2_store(r + i - AVX2_WIDTH, _mm256_or_si256(high, low));
+  }
+  return i;
 }
 
-big_integer operator|(const big_integer& a, const big_integer& b) {
-  return big_integer(a) |= b;
+[[gnu::target("avx2")]] size_t rshift_avx2(digit* r, const digit* a, size_t n, size_t cnt) {
+  size_t i = 0;
+  for (; i + AVX2_WIDTH < n; i += AVX2_WIDTH) {
+    __m256i low = avx2_shr(avx2_load(a + i), cnt);
+    __m256i high = avx2_shl(avx2_load(a + i + 1), DIGIT_LEN - cnt);
+    avx2_store(r + i, _mm256_or_si256(low, high));
+  }
+  return i;
 }
 
-big_integer operator^(const big_integer& a, const big_integer& b) {
-  return big_integer(a) ^= b;
+template <class BinaryOperation>
+[[gnu::target("avx2")]] size_t bitwise_n_avx2(digit* r, const digit* a, const digit* b, size_t n,
+                                             const BinaryOperation& op, digit a_mask, digit b_mask, digit r_mask) {
+  __m256i am = avx2_fill(a_mask);
+  __m256i bm = avx2_fill(b_mask);
+  __m256i rm = avx2_fill(r_mask);
+  size_t i = 0;
+  for (; i + AVX2_WIDTH <= n; i += AVX2_WIDTH) {
+    __m256i x = _mm256_xor_si256(avx2_load(a + i), am);
+    __m256i y = _mm256_xor_si256(avx2_load(b + i), bm);
+    avx2_store(r + i, _mm256_xor_si256(avx2_apply(op, x, y), rm));
+  }
+  return i;
 }
 
-big_integer operator<<(const big_integer& a, int b) {
-  return big_integer(a) <<= b;
+template <class BinaryOperation>
+[[gnu::target("avx2")]] size_t bitwise_1_avx2(digit* r, const digit* a, size_t n, const BinaryOperation& op,
+                                             digit a_mask, digit b, digit r_mask) {
+  __m256i am = avx2_fill(a_mask);
+  __m256i y = avx2_fill(b);
+  __m256i rm = avx2_fill(r_mask);
+  size_t i = 0;
+  for (; i + AVX2_WIDTH <= n; i += AVX2_WIDTH) {
+    __m256i x = _mm256_xor_si256(avx2_load(a + i), am);
+    avx2_store(r + i, _mm256_xor_si256(avx2_apply(op, x, y), rm));
+  }
+  return i;
 }
+#endif
 
-big_integer operator>>(const big_integer& a, int b) {
-  return big_integer(a) >>= b;
+// r[0, n) = a[0, n) << cnt, 0 < cnt < DIGIT_LEN, returns the bits shifted out
+digit lshift_generic(digit* r, const digit* a, size_t n, size_t cnt) {
+  if (n == 0) {
+    return 0;
+  }
+  digit rest = a[n - 1] >> (DIGIT_LEN - cnt);
+  // from the top, every step reads only digits below the ones it writes
+  size_t i = n;
+#ifdef BIGINT_X86_64_DISPATCH
+  if (n > AVX2_WIDTH && cpu().avx2) {
+    i = lshift_avx2(r, a, i, cnt);
+  }
+#endif
+#ifdef BIGINT_SIMD
+  for (; i > SIMD_WIDTH; i -= SIMD_WIDTH) {
+    simd high = simd_shl(simd_load(a + i - SIMD_WIDTH), cnt);
+    simd low = simd_shr(simd_load(a + i - SIMD_WIDTH - 1), DIGIT_LEN - cnt);
+    simd_store(r + i - SIMD_WIDTH, simd_apply(std::bit_or<>(), high, low));
+  }
+#endif
+  for (; i > 1; --i) {
+    r[i - 1] = (a[i - 1] << cnt) | (a[i - 2] >> (DIGIT_LEN - cnt));
+  }
+  r[0] = a[0] << cnt;
+  return rest;
 }
 
-bool operator==(const big_integer& a, const big_integer& b) {
-  return (a.is_zero() && b.is_zero()) || (a.sign == b.sign && a.data == b.data);
+// r[0, n) = a[0, n) >> cnt, 0 < cnt < DIGIT_LEN, returns the bits shifted out in the highest positions
+digit rshift_generic(digit* r, const digit* a, size_t n, size_t cnt) {
+  if (n == 0) {
+    return 0;
+  }
+  digit rest = a[0] << (DIGIT_LEN - cnt);
+  // from the bottom, every step reads only digits above the ones it writes
+  size_t i = 0;
+#ifdef BIGINT_X86_64_DISPATCH
+  if (n > AVX2_WIDTH && cpu().avx2) {
+    i = rshift_avx2(r, a, n, cnt);
+  }
+#endif
+#ifdef BIGINT_SIMD
+  for (; i + SIMD_WIDTH < n; i += SIMD_WIDTH) {
+    simd low = simd_shr(simd_load(a + i), cnt);
+    simd high = simd_shl(simd_load(a + i + 1), DIGIT_LEN - cnt);
+    simd_store(r + i, simd_apply(std::bit_or<>(), low, high));
+  }
+#endif
+  for (; i + 1 < n; ++i) {
+    r[i] = (a[i] >> cnt) | (a[i + 1] << (DIGIT_LEN - cnt));
+  }
+  r[n - 1] = a[n - 1] >> cnt;
+  return rest;
 }
 
-bool operator!=(const big_integer& a, const big_integer& b) {
-  return !(a == b);
+// r[i] = op(a[i] ^ a_mask, b[i] ^ b_mask) ^ r_mask for i < n, where the masks are zero or MAX_DIGIT
+template <class BinaryOperation>
+void bitwise_n(digit* r, const digit* a, const digit* b, size_t n, const BinaryOperation& op, digit a_mask,
+               digit b_mask, digit r_mask) {
+  size_t i = 0;
+#ifdef BIGINT_X86_64_DISPATCH
+  if (n >= AVX2_WIDTH && cpu().avx2) {
+    i = bitwise_n_avx2(r, a, b, n, op, a_mask, b_mask, r_mask);
+  }
+#endif
+#ifdef BIGINT_SIMD
+  simd am = simd_fill(a_mask);
+  simd bm = simd_fill(b_mask);
+  simd rm = simd_fill(r_mask);
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+    simd x = simd_apply(std::bit_xor<>(), simd_load(a + i), am);
+    simd y = simd_apply(std::bit_xor<>(), simd_load(b + i), bm);
+    simd_store(r + i, simd_apply(std::bit_xor<>(), simd_apply(op, x, y), rm));
+  }
+#endif
+  for (; i < n; ++i) {
+    r[i] = op(a[i] ^ a_mask, b[i] ^ b_mask) ^ r_mask;
+  }
 }
 
-bool operator<(const big_integer& a, const big_integer& b) {
-  if (a.is_zero() && b.is_zero()) {
-    return false;
+// r[i] = op(a[i] ^ a_mask, b) ^ r_mask for i < n
+template <class BinaryOperation>
+void bitwise_1(digit* r, const digit* a, size_t n, const BinaryOperation& op, digit a_mask, digit b, digit r_mask) {
+  size_t i = 0;
+#ifdef BIGINT_X86_64_DISPATCH
+  if (n >= AVX2_WIDTH && cpu().avx2) {
+    i = bitwise_1_avx2(r, a, n, op, a_mask, b, r_mask);
   }
-  if (a.sign != b.sign) {
-    return a.sign && !b.sign;
+#endif
+#ifdef BIGINT_SIMD
+  simd am = simd_fill(a_mask);
+  simd y = simd_fill(b);
+  simd rm = simd_fill(r_mask);
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+    simd x = simd_apply(std::bit_xor<>(), simd_load(a + i), am);
+    simd_store(r + i, simd_apply(std::bit_xor<>(), simd_apply(op, x, y), rm));
+  }
+#endif
+  for (; i < n; ++i) {
+    r[i] = op(a[i] ^ a_mask, b) ^ r_mask;
   }
-  return a.sign ^ unsigned_less(a, b);
 }
 
-bool operator>(const big_integer& a, const big_integer& b) {
-  return b < a;
+// The portable kernels above are replaced by the assembly ones from asm/ when those are linked in,
+// the variants are chosen by the processor features on the first call.
+struct kernel_table {
+  digit (*add_n)(digit* r, const digit* a, const digit* b, size_t n);
+  digit (*sub_n)(digit* r, const digit* a, const digit* b, size_t n);
+  digit (*mul_1)(digit* r, const digit* a, size_t n, digit b);
+  digit (*addmul_1)(digit* r, const digit* a, size_t n, digit b);
+  digit (*submul_1)(digit* r, const digit* a, size_t n, digit b);
+  digit (*divrem_1)(digit* a, size_t n, digit d);
+  digit (*lshift)(digit* r, const digit* a, size_t n, size_t cnt);
+  digit (*rshift)(digit* r, const digit* a, size_t n, size_t cnt);
+};
+
+constexpr kernel_table GENERIC_KERNELS{add_n_generic,    sub_n_generic,    mul_1_generic,  addmul_1_generic,
+                                       submul_1_generic, divrem_1_generic, lshift_generic, rshift_generic};
+
+#ifdef BIGINT_ASM_KERNELS
+kernel_table select_kernels() {
+  if (portable_kernels_requested()) {
+    return GENERIC_KERNELS;
+  }
+  __builtin_cpu_init();
+  bool adx = __builtin_cpu_supports("adx") && __builtin_cpu_supports("bmi2");
+  return {bigint_add_n,    bigint_sub_n,    bigint_mul_1, adx ? bigint_addmul_1_adx : bigint_addmul_1,
+          bigint_submul_1, bigint_divrem_1, bigint_lshift, bigint_rshift};
 }
 
-bool operator<=(const big_integer& a, const big_integer& b) {
-  return !(a > b);
+const kernel_table& kernels() {
+  static const kernel_table table = select_kernels();
+  return table;
+}
+#else
+constexpr const kernel_table& kernels() {
+  return GENERIC_KERNELS;
 }
+#endif
 
-bool operator>=(const big_integer& a, const big_integer& b) {
-  return !(a < b);
+// dispatched through the kernel table, see the portable versions for the contracts
+digit mul_1(digit* r, const digit* a, size_t n, digit b) {
+  return kernels().mul_1(r, a, n, b);
 }
 
-std::string to_string(big_integer a) {
-  std::vector<std::string> resInverted;
-  std::string s = (a.is_negative() ? "-" : "");
-  while (!a.is_zero()) {
-    resInverted.push_back(std::to_string(a.div_digit(DEC_BASE)));
+digit addmul_1(digit* r, const digit* a, size_t n, digit b) {
+  return kernels().addmul_1(r, a, n, b);
+}
+
+digit submul_1(digit* r, const digit* a, size_t n, digit b) {
+  return kernels().submul_1(r, a, n, b);
+}
+
+// divides a[0, n) in place by the digit norm >> shift, where norm is normalized and inv = reciprocal_of(norm),
+// returns the remainder. The dividend is shifted along on the fly, the quotient is the same.
+digit divrem_1_preinv(digit* a, size_t n, digit norm, digit inv, unsigned shift) {
+  if (n == 0) {
+    return 0;
   }
-  if (resInverted.empty()) {
-    s += "0";
-  } else {
-    s.reserve(resInverted.size() * DEC_DIGIT_LEN);
-    s += resInverted.back();
-    for (auto it = resInverted.rbegin() + 1; it != resInverted.rend(); ++it) {
-      s += std::string(DEC_DIGIT_LEN - it->size(), '0') + *it;
+  digit r = 0;
+  if (shift == 0) {
+    for (size_t i = n; i-- > 0;) {
+      a[i] = div_2by1(r, a[i], norm, inv);
     }
+    return r;
   }
-  return s;
+  r = a[n - 1] >> (DIGIT_LEN - shift);
+  for (size_t i = n; i-- > 0;) {
+    digit u = (a[i] << shift) | (i > 0 ? a[i - 1] >> (DIGIT_LEN - shift) : 0);
+    a[i] = div_2by1(r, u, norm, inv);
+  }
+  return r >> shift;
 }
 
-bool big_integer::is_zero() const {
-  return data.empty();
+// the reciprocal costs one hardware division, it pays off from a few digits on
+digit divrem_1(digit* a, size_t n, digit d) {
+  if (n < DIVREM_1_PREINV_THRESHOLD) {
+    return kernels().divrem_1(a, n, d);
+  }
+  unsigned shift = std::countl_zero(d);
+  return divrem_1_preinv(a, n, d << shift, reciprocal_of(d << shift), shift);
 }
 
-bool big_integer::is_positive() const {
-  return !is_zero() && !sign;
+digit lshift(digit* r, const digit* a, size_t n, size_t cnt) {
+  return kernels().lshift(r, a, n, cnt);
 }
 
-bool big_integer::is_negative() const {
-  return !is_zero() && sign;
+digit rshift(digit* r, const digit* a, size_t n, size_t cnt) {
+  return kernels().rshift(r, a, n, cnt);
 }
 
-void big_integer::shrink() {
-  while (!data.empty() && !data.back()) {
-    data.pop_back();
+// r[0, an) = a[0, an) + b[0, bn), an >= bn, returns carry
+digit add(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  digit carry = kernels().add_n(r, a, b, bn);
+  for (size_t i = bn; i < an; ++i) {
+    r[i] = a[i] + carry;
+    carry = carry && r[i] == 0;
   }
+  return carry;
 }
 
-void swap(big_integer& a, big_integer& b) {
-  std::swap(a.data, b.data);
-  std::swap(a.sign, b.sign);
+// r[0, an) = a[0, an) - b[0, bn), an >= bn, returns borrow
+digit sub(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  digit borrow = kernels().sub_n(r, a, b, bn);
+  for (size_t i = bn; i < an; ++i) {
+    digit ai = a[i];
+    r[i] = ai - borrow;
+    borrow = borrow && ai == 0;
+  }
+  return borrow;
 }
 
-big_integer& big_integer::negate() {
-  sign = !sign;
-  return *this;
+// compares a[0, an) and b[0, bn), an >= bn
+int cmp(const digit* a, size_t an, const digit* b, size_t bn) {
+  for (size_t i = an; i > bn; --i) {
+    if (a[i - 1] != 0) {
+      return 1;
+    }
+  }
+  for (size_t i = bn; i > 0; --i) {
+    if (a[i - 1] != b[i - 1]) {
+      return a[i - 1] < b[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
 }
 
-big_integer& big_integer::resize(size_t len) {
-  data.resize(len, 0);
-  return *this;
+// r[0, an) = |a[0, an) - b[0, bn)|, an >= bn, returns true if a < b
+bool abs_diff(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  if (cmp(a, an, b, bn) >= 0) {
+    sub(r, a, an, b, bn);
+    return false;
+  }
+  sub(r, b, bn, a, bn);
+  std::fill(r + bn, r + an, 0);
+  return true;
 }
 
-big_integer& big_integer::true_negate(size_t len) {
-  resize(len);
-  for (auto& v : data) {
-    v = ~v;
+// two's complement negation of r[0, n)
+void negate_n(digit* r, size_t n) {
+  digit carry = 1;
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = ~r[i] + carry;
+    carry = carry && r[i] == 0;
   }
-  add_digit(1);
-  return *this;
 }
 
-std::ostream& operator<<(std::ostream& out, const big_integer& a) {
-  return out << to_string(a);
+// arithmetic shift of the two's complement r[0, n) by one bit to the right
+void half_n(digit* r, size_t n) {
+  for (size_t i = 0; i + 1 < n; ++i) {
+    r[i] = (r[i] >> 1) | (r[i + 1] << (DIGIT_LEN - 1));
+  }
+  r[n - 1] = (r[n - 1] >> 1) | (r[n - 1] & (digit(1) << (DIGIT_LEN - 1)));
+}
+
+// r[0, n) = a[0, n) / 3 modulo BASE^n, exact if a is divisible by 3 in two's complement
+void divexact_by3(digit* r, const digit* a, size_t n) {
+  static const digit INV3 = MAX_DIGIT / 3 * 2 + 1; // 3 * INV3 == 1 (mod BASE)
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    digit ai = a[i];
+    digit s = ai - carry;
+    digit borrow = s > ai;
+    digit q = s * INV3;
+    r[i] = q;
+    carry = static_cast<digit>((static_cast<double_digit>(q) * 3) >> DIGIT_LEN) + borrow;
+  }
+}
+
+// r[0, an + bn) = a[0, an) * b[0, bn), bn >= 1, r must not overlap with operands
+void mul_basecase(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  r[an] = mul_1(r, a, an, b[0]);
+  for (size_t i = 1; i < bn; ++i) {
+    r[an + i] = addmul_1(r + i, a, an, b[i]);
+  }
+}
+
+// r[0, 2n) = a[0, n)^2, each cross product is computed once
+void sqr_basecase(digit* r, const digit* a, size_t n) {
+  std::fill(r, r + 2 * n, 0);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+  }
+  lshift(r, r, 2 * n, 1);
+  digit carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    double_digit sq = static_cast<double_digit>(a[i]) * a[i];
+    double_digit low = static_cast<double_digit>(r[2 * i]) + static_cast<digit>(sq) + carry;
+    double_digit high = static_cast<double_digit>(r[2 * i + 1]) + static_cast<digit>(sq >> DIGIT_LEN) + (low >> DIGIT_LEN);
+    r[2 * i] = static_cast<digit>(low);
+    r[2 * i + 1] = static_cast<digit>(high);
+    carry = static_cast<digit>(high >> DIGIT_LEN);
+  }
+}
+
+// Number-theoretic transform over three primes p < 2^31 with 2^k | p - 1. Digits are split into
+// 32-bit coefficients, whose convolution is restored exactly by the chinese remainder theorem
+// since its values are below 2^25 * 2^64 = 2^89 < p1 * p2 * p3
+class ntt_field {
+public:
+  constexpr ntt_field(uint32_t mod, uint32_t generator, size_t max_log)
+      : _mod(mod), _mod_inv(minus_inverse(mod)), _r2(static_cast<uint32_t>(
+                                                      ((uint64_t(1) << 32) % mod) * ((uint64_t(1) << 32) % mod) % mod)),
+        _generator(generator), _max_log(max_log) {}
+
+  uint32_t mod() const {
+    return _mod;
+  }
+
+  size_t max_log() const {
+    return _max_log;
+  }
+
+  // values are kept in Montgomery form x * 2^32 mod p
+  uint32_t to_form(uint32_t x) const {
+    return reduce(static_cast<uint64_t>(x) * _r2);
+  }
+
+  uint32_t from_form(uint32_t x) const {
+    return reduce(x);
+  }
+
+  uint32_t add(uint32_t a, uint32_t b) const {
+    uint32_t sum = a + b;
+    return sum >= _mod ? sum - _mod : sum;
+  }
+
+  uint32_t sub(uint32_t a, uint32_t b) const {
+    return a >= b ? a - b : a + _mod - b;
+  }
+
+  uint32_t mul(uint32_t a, uint32_t b) const {
+    return reduce(static_cast<uint64_t>(a) * b);
+  }
+
+  uint32_t pow(uint32_t a, uint64_t e) const {
+    uint32_t res = to_form(1);
+    for (; e != 0; e >>= 1, a = mul(a, a)) {
+      if (e & 1) {
+        res = mul(res, a);
+      }
+    }
+    return res;
+  }
+
+  // primitive root of unity of degree 2^log in Montgomery form
+  uint32_t root(size_t log, bool inverse) const {
+    uint32_t w = pow(to_form(_generator), (_mod - 1) >> log);
+    return inverse ? pow(w, (uint64_t(1) << log) - 1) : w;
+  }
+
+private:
+  static constexpr uint32_t minus_inverse(uint32_t mod) {
+    uint32_t inv = mod;
+    for (int i = 0; i < 4; ++i) {
+      inv *= 2 - mod * inv;
+    }
+    return -inv;
+  }
+
+  uint32_t reduce(uint64_t x) const {
+    uint32_t m = static_cast<uint32_t>(x) * _mod_inv;
+    uint32_t res = static_cast<uint32_t>((x + static_cast<uint64_t>(m) * _mod) >> 32);
+    return res >= _mod ? res - _mod : res;
+  }
+
+  uint32_t _mod;
+  uint32_t _mod_inv;
+  uint32_t _r2;
+  uint32_t _generator;
+  size_t _max_log;
+};
+
+const ntt_field NTT_FIELDS[]{{2013265921, 31, 27}, {1811939329, 13, 26}, {2113929217, 5, 25}};
+const size_t NTT_MAX_LOG = 25;
+const size_t NTT_COEF_LEN = 32;
+const size_t NTT_COEFS_PER_DIGIT = DIGIT_LEN / NTT_COEF_LEN;
+static_assert(DIGIT_LEN % NTT_COEF_LEN == 0);
+
+// transforms take their memory from small_vector_resource like the digits do
+using ntt_vector = small_vector<uint32_t, 4>;
+
+// writes the coefficients of a[0, n) in Montgomery form to res
+void ntt_load(const ntt_field& f, const digit* a, size_t n, uint32_t* res) {
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < NTT_COEFS_PER_DIGIT; ++j) {
+      res[i * NTT_COEFS_PER_DIGIT + j] = f.to_form(static_cast<uint32_t>(a[i] >> (j * NTT_COEF_LEN)));
+    }
+  }
+}
+
+// roots[len + j] = w_{2 len}^j for every power of two len < n
+ntt_vector ntt_roots(const ntt_field& f, size_t log, bool inverse) {
+  size_t n = size_t(1) << log;
+  ntt_vector roots(std::max<size_t>(n, 2));
+  size_t half = n / 2;
+  uint32_t w = f.root(log, inverse);
+  roots[half] = f.to_form(1);
+  for (size_t j = 1; j < half; ++j) {
+    roots[half + j] = f.mul(roots[half + j - 1], w);
+  }
+  for (size_t len = half / 2; len > 0; len /= 2) {
+    for (size_t j = 0; j < len; ++j) {
+      roots[len + j] = roots[2 * len + 2 * j];
+    }
+  }
+  return roots;
+}
+
+// decimation in frequency, the result is in bit-reversed order
+void ntt_forward(const ntt_field& f, uint32_t* a, size_t n, const uint32_t* roots) {
+  if (parallel(n)) {
+    // after the first stage the halves are independent transforms
+    size_t half = n / 2;
+    for_range(half, [&](size_t lo, size_t hi) {
+      for (size_t j = lo; j < hi; ++j) {
+        uint32_t u = a[j];
+        uint32_t v = a[j + half];
+        a[j] = f.add(u, v);
+        a[j + half] = f.mul(f.sub(u, v), roots[half + j]);
+      }
+    });
+    fork([&] { ntt_forward(f, a, half, roots); }, [&] { ntt_forward(f, a + half, half, roots); });
+    return;
+  }
+  for (size_t len = n / 2; len > 0; len /= 2) {
+    for (size_t i = 0; i < n; i += 2 * len) {
+      for (size_t j = 0; j < len; ++j) {
+        uint32_t u = a[i + j];
+        uint32_t v = a[i + j + len];
+        a[i + j] = f.add(u, v);
+        a[i + j + len] = f.mul(f.sub(u, v), roots[len + j]);
+      }
+    }
+  }
+}
+
+// decimation in time from bit-reversed order, the result is multiplied by n
+void ntt_inverse(const ntt_field& f, uint32_t* a, size_t n, const uint32_t* roots) {
+  if (parallel(n)) {
+    // the halves are independent transforms joined by the last stage
+    size_t half = n / 2;
+    fork([&] { ntt_inverse(f, a, half, roots); }, [&] { ntt_inverse(f, a + half, half, roots); });
+    for_range(half, [&](size_t lo, size_t hi) {
+      for (size_t j = lo; j < hi; ++j) {
+        uint32_t u = a[j];
+        uint32_t v = f.mul(a[j + half], roots[half + j]);
+        a[j] = f.add(u, v);
+        a[j + half] = f.sub(u, v);
+      }
+    });
+    return;
+  }
+  for (size_t len = 1; len < n; len *= 2) {
+    for (size_t i = 0; i < n; i += 2 * len) {
+      for (size_t j = 0; j < len; ++j) {
+        uint32_t u = a[i + j];
+        uint32_t v = f.mul(a[i + j + len], roots[len + j]);
+        a[i + j] = f.add(u, v);
+        a[i + j + len] = f.sub(u, v);
+      }
+    }
+  }
+}
+
+// cyclic convolution of a[0, an) and b[0, bn) modulo f.mod() of length 2^log
+ntt_vector ntt_convolution(const ntt_field& f, size_t log, const digit* a, size_t an, const digit* b, size_t bn,
+                           ntt_vector& buffer) {
+  size_t n = size_t(1) << log;
+  ntt_vector fa(n, 0);
+  ntt_load(f, a, an, fa.data());
+  ntt_vector roots = ntt_roots(f, log, false);
+  ntt_forward(f, fa.data(), n, roots.data());
+  if (a != b || an != bn) {
+    buffer.clear();
+    buffer.resize(n, 0);
+    ntt_load(f, b, bn, buffer.data());
+    ntt_forward(f, buffer.data(), n, roots.data());
+  } else {
+    buffer = fa;
+  }
+
+  uint32_t n_inv = f.pow(f.to_form(static_cast<uint32_t>(n)), f.mod() - 2);
+  for_range(n, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      fa[i] = f.mul(f.mul(fa[i], buffer[i]), n_inv);
+    }
+  });
+  roots = ntt_roots(f, log, true);
+  ntt_inverse(f, fa.data(), n, roots.data());
+  for_range(n, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      fa[i] = f.from_form(fa[i]);
+    }
+  });
+  return fa;
+}
+
+bool ntt_fits(size_t an, size_t bn) {
+  return (an + bn) * NTT_COEFS_PER_DIGIT - 1 <= (size_t(1) << NTT_MAX_LOG);
+}
+
+// r[0, an + bn) = a[0, an) * b[0, bn), passing the same operand twice saves one transform per prime
+void ntt_mul(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  assert(ntt_fits(an, bn));
+  size_t log = 0;
+  while ((size_t(1) << log) < (an + bn) * NTT_COEFS_PER_DIGIT - 1) {
+    ++log;
+  }
+
+  ntt_vector res[3];
+  if (parallel(an + bn)) {
+    ntt_vector buffers[3];
+    auto convolution = [&](size_t i) { res[i] = ntt_convolution(NTT_FIELDS[i], log, a, an, b, bn, buffers[i]); };
+    fork([&] { convolution(0); }, [&] { convolution(1); }, [&] { convolution(2); });
+  } else {
+    ntt_vector buffer;
+    for (size_t i = 0; i < 3; ++i) {
+      res[i] = ntt_convolution(NTT_FIELDS[i], log, a, an, b, bn, buffer);
+    }
+  }
+
+  // Garner's algorithm: x = t1 + p1 * t2 + p1 * p2 * t3
+  const uint64_t p1 = NTT_FIELDS[0].mod();
+  const uint64_t p2 = NTT_FIELDS[1].mod();
+  const uint64_t p3 = NTT_FIELDS[2].mod();
+  const uint64_t p1_inv_p2 = NTT_FIELDS[1].from_form(NTT_FIELDS[1].pow(NTT_FIELDS[1].to_form(p1 % p2), p2 - 2));
+  const uint64_t p1_inv_p3 = NTT_FIELDS[2].from_form(NTT_FIELDS[2].pow(NTT_FIELDS[2].to_form(p1 % p3), p3 - 2));
+  const uint64_t p2_inv_p3 = NTT_FIELDS[2].from_form(NTT_FIELDS[2].pow(NTT_FIELDS[2].to_form(p2), p3 - 2));
+  const uint64_t p12 = p1 * p2;
+  const uint64_t low_mask = UINT32_MAX;
+
+  std::fill(r, r + an + bn, 0);
+  uint64_t carry = 0;
+  size_t len = (an + bn) * NTT_COEFS_PER_DIGIT;
+  for (size_t i = 0; i + 1 < len; ++i) {
+    uint64_t t1 = res[0][i];
+    uint64_t t2 = (res[1][i] + p2 - t1 % p2) * p1_inv_p2 % p2;
+    uint64_t t3 = ((res[2][i] + p3 - t1 % p3) * p1_inv_p3 % p3 + p3 - t2) * p2_inv_p3 % p3;
+    uint64_t v = t1 + p1 * t2;
+    uint64_t w_low = (p12 & low_mask) * t3;
+    uint64_t w_high = (p12 >> NTT_COEF_LEN) * t3;
+    uint64_t low = (v & low_mask) + (w_low & low_mask) + (carry & low_mask);
+    r[i / NTT_COEFS_PER_DIGIT] |= static_cast<digit>(low & low_mask) << (i % NTT_COEFS_PER_DIGIT * NTT_COEF_LEN);
+    carry = (v >> NTT_COEF_LEN) + (w_low >> NTT_COEF_LEN) + w_high + (carry >> NTT_COEF_LEN) + (low >> NTT_COEF_LEN);
+  }
+  r[an + bn - 1] |= static_cast<digit>(carry) << (DIGIT_LEN - NTT_COEF_LEN);
+}
+
+size_t toom3_part(size_t n) {
+  return (n + 2) / 3;
+}
+
+// operands too long for a single transform are split by Toom-3 first
+template <bool Square>
+bool use_ntt(size_t n) {
+  return n >= (Square ? SQR_NTT_THRESHOLD : NTT_THRESHOLD) && ntt_fits(n, n);
+}
+
+// number of scratch digits needed to multiply (square if Square) two n-digit numbers
+template <bool Square>
+size_t mul_scratch(size_t n) {
+  if (n < (Square ? SQR_KARATSUBA_THRESHOLD : KARATSUBA_THRESHOLD)) {
+    return 0;
+  }
+  if (use_ntt<Square>(n)) {
+    return 0;
+  }
+  // the scratch of the parts is not monotonic in their size as they may fall into different tiers
+  if (n < (Square ? SQR_TOOM3_THRESHOLD : TOOM3_THRESHOLD)) {
+    size_t hi = n - n / 2;
+    return 6 * hi + 1 + std::max(mul_scratch<Square>(n / 2), mul_scratch<Square>(hi));
+  }
+  size_t k = toom3_part(n);
+  size_t n2 = n - 2 * k;
+  return 6 * (k + 1) + 3 * (2 * k + 2) +
+         std::max({mul_scratch<Square>(n2), mul_scratch<Square>(k), mul_scratch<Square>(k + 1)});
+}
+
+template <bool Square>
+void mul_n(digit* r, const digit* a, const digit* b, size_t n, digit* scratch);
+
+// mul_n with a scratch of its own, as parallel sub-products can't share one
+template <bool Square>
+void mul_n_alloc(digit* r, const digit* a, const digit* b, size_t n) {
+  digit_vector scratch(mul_scratch<Square>(n));
+  mul_n<Square>(r, a, b, n, scratch.data());
+}
+
+// r[0, 2n) = a[0, n) * b[0, n) via
+// a0 * b0 + (a0 * b0 + a1 * b1 - (a1 - a0) * (b1 - b0)) * BASE^lo + a1 * b1 * BASE^(2lo)
+template <bool Square>
+void karatsuba(digit* r, const digit* a, const digit* b, size_t n, digit* scratch) {
+  size_t lo = n / 2;
+  size_t hi = n - lo;
+  digit* da = scratch;
+  digit* db = Square ? da : scratch + hi;
+  digit* prod = scratch + 2 * hi;
+  digit* mid = prod + 2 * hi;
+  digit* next = mid + 2 * hi + 1;
+
+  bool negative = abs_diff(da, a + lo, hi, a, lo);
+  if (Square) {
+    negative = false;
+  } else {
+    negative ^= abs_diff(db, b + lo, hi, b, lo);
+  }
+
+  if (parallel(n)) {
+    fork([&] { mul_n_alloc<Square>(r, a, b, lo); }, [&] { mul_n_alloc<Square>(r + 2 * lo, a + lo, b + lo, hi); },
+         [&] { mul_n_alloc<Square>(prod, da, db, hi); });
+  } else {
+    mul_n<Square>(r, a, b, lo, next);
+    mul_n<Square>(r + 2 * lo, a + lo, b + lo, hi, next);
+    mul_n<Square>(prod, da, db, hi, next);
+  }
+
+  mid[2 * hi] = add(mid, r + 2 * lo, 2 * hi, r, 2 * lo);
+  if (negative) {
+    add(mid, mid, 2 * hi + 1, prod, 2 * hi);
+  } else {
+    sub(mid, mid, 2 * hi + 1, prod, 2 * hi);
+  }
+  add(r + lo, r + lo, 2 * n - lo, mid, 2 * hi + 1);
+}
+
+// writes a0 + a1 + a2 to e1, |a0 - a1 + a2| to em1, |a0 - 2 * a1 + 4 * a2| to em2 (k + 1 digits each),
+// returns signs of the last two values, tmp must hold k + 1 digits
+std::pair<bool, bool> toom3_evaluate(const digit* a, size_t k, size_t n2, digit* e1, digit* em1, digit* em2,
+                                     digit* tmp) {
+  const digit* a1 = a + k;
+  const digit* a2 = a + 2 * k;
+
+  em1[k] = add(em1, a, k, a2, n2);
+  e1[k] = em1[k] + add(e1, em1, k, a1, k);
+  bool sign_m1 = abs_diff(em1, em1, k + 1, a1, k);
+
+  std::copy(a2, a2 + n2, tmp);
+  std::fill(tmp + n2, tmp + k + 1, 0);
+  for (size_t i = k + 1; i-- > 0;) {
+    tmp[i] = (tmp[i] << 2) | (i > 0 ? tmp[i - 1] >> (DIGIT_LEN - 2) : 0);
+  }
+  add(em2, tmp, k + 1, a, k);
+  tmp[k] = 0;
+  for (size_t i = k + 1; i-- > 0;) {
+    tmp[i] = (i < k ? a1[i] << 1 : 0) | (i > 0 ? a1[i - 1] >> (DIGIT_LEN - 1) : 0);
+  }
+  bool sign_m2 = abs_diff(em2, em2, k + 1, tmp, k + 1);
+  return {sign_m1, sign_m2};
+}
+
+// r[0, 2n) = a[0, n) * b[0, n) by evaluation in 0, 1, -1, -2, inf and Bodrato's interpolation sequence,
+// intermediate values are kept as (2k + 2)-digit two's complement numbers
+template <bool Square>
+void toom3(digit* r, const digit* a, const digit* b, size_t n, digit* scratch) {
+  size_t k = toom3_part(n);
+  size_t n2 = n - 2 * k;
+  size_t len = 2 * k + 2;
+
+  digit* e1a = scratch;
+  digit* em1a = e1a + (k + 1);
+  digit* em2a = em1a + (k + 1);
+  digit* e1b = em2a + (k + 1);
+  digit* em1b = e1b + (k + 1);
+  digit* em2b = em1b + (k + 1);
+  digit* v1 = em2b + (k + 1);
+  digit* vm1 = v1 + len;
+  digit* vm2 = vm1 + len;
+  digit* next = vm2 + len;
+
+  auto [sign_m1, sign_m2] = toom3_evaluate(a, k, n2, e1a, em1a, em2a, vm2);
+  if (Square) {
+    sign_m1 = sign_m2 = false;
+    e1b = e1a;
+    em1b = em1a;
+    em2b = em2a;
+  } else {
+    auto [sign_m1b, sign_m2b] = toom3_evaluate(b, k, n2, e1b, em1b, em2b, vm2);
+    sign_m1 ^= sign_m1b;
+    sign_m2 ^= sign_m2b;
+  }
+
+  digit* v0 = r;
+  digit* vinf = r + 4 * k;
+  if (parallel(n)) {
+    fork([&] { mul_n_alloc<Square>(v0, a, b, k); }, [&] { mul_n_alloc<Square>(vinf, a + 2 * k, b + 2 * k, n2); },
+         [&] { mul_n_alloc<Square>(v1, e1a, e1b, k + 1); }, [&] { mul_n_alloc<Square>(vm1, em1a, em1b, k + 1); },
+         [&] { mul_n_alloc<Square>(vm2, em2a, em2b, k + 1); });
+  } else {
+    mul_n<Square>(v0, a, b, k, next);
+    mul_n<Square>(vinf, a + 2 * k, b + 2 * k, n2, next);
+    mul_n<Square>(v1, e1a, e1b, k + 1, next);
+    mul_n<Square>(vm1, em1a, em1b, k + 1, next);
+    mul_n<Square>(vm2, em2a, em2b, k + 1, next);
+  }
+  if (sign_m1) {
+    negate_n(vm1, len);
+  }
+  if (sign_m2) {
+    negate_n(vm2, len);
+  }
+
+  // r3 = (vm2 - v1) / 3
+  sub(vm2, vm2, len, v1, len);
+  divexact_by3(vm2, vm2, len);
+  // r1 = (v1 - vm1) / 2
+  sub(v1, v1, len, vm1, len);
+  half_n(v1, len);
+  // r2 = vm1 - v0
+  sub(vm1, vm1, len, v0, 2 * k);
+  // r3 = (r2 - r3) / 2 + 2 * vinf
+  sub(vm2, vm1, len, vm2, len);
+  half_n(vm2, len);
+  add(vm2, vm2, len, vinf, 2 * n2);
+  add(vm2, vm2, len, vinf, 2 * n2);
+  // r2 = r2 + r1 - vinf
+  add(vm1, vm1, len, v1, len);
+  sub(vm1, vm1, len, vinf, 2 * n2);
+  // r1 = r1 - r3
+  sub(v1, v1, len, vm2, len);
+
+  // all coefficients are non-negative now, their digits beyond the product are zero
+  std::fill(r + 2 * k, r + 4 * k, 0);
+  add(r + k, r + k, 2 * n - k, v1, std::min(len, 2 * n - k));
+  add(r + 2 * k, r + 2 * k, 2 * n - 2 * k, vm1, std::min(len, 2 * n - 2 * k));
+  add(r + 3 * k, r + 3 * k, 2 * n - 3 * k, vm2, std::min(len, 2 * n - 3 * k));
+}
+
+// r[0, 2n) = a[0, n) * b[0, n), b is ignored if Square, r must not overlap with operands
+template <bool Square>
+void mul_n(digit* r, const digit* a, const digit* b, size_t n, digit* scratch) {
+  if (n < (Square ? SQR_KARATSUBA_THRESHOLD : KARATSUBA_THRESHOLD)) {
+    if (Square) {
+      sqr_basecase(r, a, n);
+    } else {
+      mul_basecase(r, a, n, b, n);
+    }
+  } else if (use_ntt<Square>(n)) {
+    ntt_mul(r, a, n, Square ? a : b, n);
+  } else if (n < (Square ? SQR_TOOM3_THRESHOLD : TOOM3_THRESHOLD)) {
+    karatsuba<Square>(r, a, b, n, scratch);
+  } else {
+    toom3<Square>(r, a, b, n, scratch);
+  }
+}
+
+// r[0, 2n) = a[0, n)^2
+void sqr(digit* r, const digit* a, size_t n) {
+  mul_n_alloc<true>(r, a, a, n);
+}
+
+// r[0, an + bn) = a[0, an) * b[0, bn), an >= bn >= 1, r must not overlap with operands
+void mul(digit* r, const digit* a, size_t an, const digit* b, size_t bn) {
+  if (bn < KARATSUBA_THRESHOLD) {
+    mul_basecase(r, a, an, b, bn);
+    return;
+  }
+  if (bn >= NTT_THRESHOLD && ntt_fits(an, bn)) {
+    ntt_mul(r, a, an, b, bn);
+    return;
+  }
+  digit_vector scratch(mul_scratch<false>(bn));
+  mul_n<false>(r, a, b, bn, scratch.data());
+  if (an == bn) {
+    return;
+  }
+  // unbalanced operands are multiplied by bn-digit slices of a
+  digit_vector prod(2 * bn);
+  for (size_t done = bn; done < an; done += bn) {
+    size_t len = std::min(bn, an - done);
+    if (len == bn) {
+      mul_n<false>(prod.data(), a + done, b, bn, scratch.data());
+    } else {
+      mul(prod.data(), b, bn, a + done, len);
+    }
+    std::fill(r + done + bn, r + done + bn + len, 0);
+    add(r + done, r + done, bn + len, prod.data(), bn + len);
+  }
+}
+
+// Knuth's algorithm D on a normalized divisor (the highest bit of v[vn - 1] is set), vn >= 2:
+// q[0, un - vn + 1) = u[0, un + 1) / v[0, vn), the remainder is left in u[0, vn),
+// the top vn digits of u must be less than v
+void divrem_normalized(digit* q, digit* u, size_t un, const digit* v, size_t vn) {
+  digit v1 = v[vn - 1];
+  digit v2 = v[vn - 2];
+  digit v1_inv = reciprocal_of(v1);
+  for (size_t j = un - vn + 1; j-- > 0;) {
+    digit* uj = u + j;
+    // estimate from the top two digits of the divisor, qhat exceeds the real digit by at most 2
+    double_digit qhat;
+    double_digit rhat;
+    if (uj[vn] < v1) {
+      digit r = uj[vn];
+      qhat = div_2by1(r, uj[vn - 1], v1, v1_inv);
+      rhat = r;
+    } else {
+      double_digit num = (static_cast<double_digit>(uj[vn]) << DIGIT_LEN) | uj[vn - 1];
+      qhat = num / v1;
+      rhat = num % v1;
+    }
+    while (qhat > MAX_DIGIT || qhat * v2 > ((rhat << DIGIT_LEN) | uj[vn - 2])) {
+      --qhat;
+      rhat += v1;
+      if (rhat > MAX_DIGIT) {
+        break;
+      }
+    }
+    digit borrow = submul_1(uj, v, vn, static_cast<digit>(qhat));
+    digit top = uj[vn];
+    uj[vn] = top - borrow;
+    if (top < borrow) {
+      // happens with probability about 2 / BASE
+      --qhat;
+      uj[vn] += add(uj, uj, vn, v, vn);
+    }
+    q[j] = static_cast<digit>(qhat);
+  }
+}
+
+void div_2n_by_n(digit* q, digit* a, const digit* d, size_t n, digit* scratch);
+
+// number of scratch digits needed to divide 2n digits by n
+size_t div_scratch(size_t n) {
+  return n < DC_DIV_THRESHOLD ? 0 : n + div_scratch(n - n / 2);
+}
+
+// Burnikel-Ziegler step dividing by a normalized d[0, n) with 1 <= k <= n: q[0, k) = a[0, n + k) / d,
+// the remainder replaces a[0, n), a[n, n + k) must be less than d. The quotient is estimated by
+// dividing the top 2k digits of a by the top k digits of d and corrected by the product with the
+// low n - k digits of d, which is at most two steps off.
+void div_step(digit* q, digit* a, const digit* d, size_t n, size_t k, digit* scratch) {
+  if (k == n) {
+    div_2n_by_n(q, a, d, n, scratch);
+    return;
+  }
+  const digit* d1 = d + (n - k);
+  digit* a_top = a + (n - k);
+  if (cmp(a + n, k, d1, k) < 0) {
+    div_2n_by_n(q, a_top, d1, k, scratch + n);
+  } else {
+    // the quotient is capped by BASE^k - 1, a_top - d1 * (BASE^k - 1) = a_top[0, k) + d1
+    std::fill(q, q + k, MAX_DIGIT);
+    digit carry = add(a_top, a_top, k, d1, k);
+    std::fill(a_top + k, a_top + 2 * k, 0);
+    a[n] = carry;
+  }
+
+  digit* prod = scratch;
+  if (k >= n - k) {
+    mul(prod, q, k, d, n - k);
+  } else {
+    mul(prod, d, n - k, q, k);
+  }
+  digit borrow = sub(a, a, n + 1, prod, n);
+  while (borrow) {
+    static const digit ONE = 1;
+    sub(q, q, k, &ONE, 1);
+    borrow -= add(a, a, n + 1, d, n);
+  }
+}
+
+// q[0, n) = a[0, 2n) / d[0, n), the remainder replaces a[0, n), d is normalized and a[n, 2n) < d
+void div_2n_by_n(digit* q, digit* a, const digit* d, size_t n, digit* scratch) {
+  if (n < DC_DIV_THRESHOLD) {
+    divrem_normalized(q, a, 2 * n - 1, d, n);
+    return;
+  }
+  size_t lo = n / 2;
+  size_t hi = n - lo;
+  div_step(q + lo, a + lo, d, n, hi, scratch);
+  div_step(q, a, d, n, lo, scratch);
+}
+
+// divides u[0, un + 1) by a normalized v[0, vn) in blocks of vn quotient digits, u[un] < v[vn - 1]
+void divrem_dc(digit* q, digit* u, size_t un, const digit* v, size_t vn) {
+  digit_vector scratch(vn + div_scratch(vn));
+  size_t qn = un - vn + 1;
+  size_t k = qn % vn;
+  if (k == 1) {
+    divrem_normalized(q + qn - 1, u + qn - 1, vn, v, vn);
+  } else if (k > 1) {
+    div_step(q + qn - k, u + qn - k, v, vn, k, scratch.data());
+  }
+  for (size_t j = qn - k; j > 0;) {
+    j -= vn;
+    div_2n_by_n(q + j, u + j, v, vn, scratch.data());
+  }
+}
+
+// q[0, un - vn + 1) = u[0, un) / v[0, vn), the remainder replaces u[0, vn), un >= vn >= 2, v[vn - 1] != 0,
+// u must have room for un + 1 digits
+void divrem(digit* q, digit* u, size_t un, const digit* v, size_t vn) {
+  size_t shift = std::countl_zero(v[vn - 1]);
+  digit_vector normalized;
+  if (shift != 0) {
+    normalized.resize(vn);
+    lshift(normalized.data(), v, vn, shift);
+    v = normalized.data();
+  }
+  u[un] = shift == 0 ? 0 : lshift(u, u, un, shift);
+  if (vn < DC_DIV_THRESHOLD || un - vn + 1 < DC_DIV_THRESHOLD) {
+    divrem_normalized(q, u, un, v, vn);
+  } else {
+    divrem_dc(q, u, un, v, vn);
+  }
+  if (shift != 0) {
+    rshift(u, u, vn, shift);
+  }
+}
+
+// adds d to r[0, n) and returns the carry out of it, stops as soon as the carry is absorbed
+digit add_1(digit* r, size_t n, digit d) {
+  for (size_t i = 0; i < n && d != 0; ++i) {
+    r[i] += d;
+    d = r[i] < d;
+  }
+  return d;
+}
+
+digit sub_1(digit* r, size_t n, digit d) {
+  for (size_t i = 0; i < n && d != 0; ++i) {
+    digit ri = r[i];
+    r[i] = ri - d;
+    d = ri < d;
+  }
+  return d;
+}
+} // namespace
+
+big_integer_product operator*(const big_integer& a, const big_integer& b) noexcept {
+  return {a, b};
+}
+
+big_integer_product operator*(big_integer&& a, const big_integer& b) noexcept {
+  return {std::move(a), b};
+}
+
+big_integer_product operator*(const big_integer& a, big_integer&& b) noexcept {
+  return {a, std::move(b)};
+}
+
+big_integer_product operator*(big_integer&& a, big_integer&& b) noexcept {
+  return {std::move(a), std::move(b)};
+}
+
+big_integer_product::operator big_integer() const {
+  const big_integer& a = lhs();
+  const big_integer& b = rhs();
+  BIGINT_PROBE(MUL, a.data.size(), b.data.size());
+  big_integer res;
+  if (a.is_zero() || b.is_zero()) {
+    return res;
+  }
+  res.data.resize(a.data.size() + b.data.size());
+  if (a.data == b.data) {
+    sqr(res.data.data(), a.data.data(), a.data.size());
+  } else if (a.data.size() >= b.data.size()) {
+    mul(res.data.data(), a.data.data(), a.data.size(), b.data.data(), b.data.size());
+  } else {
+    mul(res.data.data(), b.data.data(), b.data.size(), a.data.data(), a.data.size());
+  }
+  res.sign = a.sign ^ b.sign;
+  res.shrink();
+  return res;
+}
+
+big_integer& big_integer::operator*=(const big_integer& rhs) {
+  return *this = *this * rhs;
+}
+
+void big_integer::add_product(const big_integer& b, const digit* c, size_t cn, bool negative) {
+  if (b.is_zero() || cn == 0) {
+    return;
+  }
+  bool product_sign = b.sign ^ negative;
+  if (is_zero()) {
+    sign = product_sign;
+  }
+  const digit* x = b.data.data();
+  size_t xn = b.data.size();
+  const digit* y = c;
+  size_t yn = cn;
+  if (xn < yn) {
+    std::swap(x, y);
+    std::swap(xn, yn);
+  }
+  size_t n = std::max(data.size(), xn + yn) + 1;
+  data.resize(n);
+  digit* r = data.data();
+  bool subtract = sign != product_sign;
+  digit borrow = 0;
+  if (yn < KARATSUBA_THRESHOLD) {
+    // schoolbook rows go straight into the accumulator
+    for (size_t i = 0; i < yn; ++i) {
+      if (subtract) {
+        borrow |= sub_1(r + i + xn, n - i - xn, submul_1(r + i, x, xn, y[i]));
+      } else {
+        add_1(r + i + xn, n - i - xn, addmul_1(r + i, x, xn, y[i]));
+      }
+    }
+  } else {
+    digit_vector product(xn + yn);
+    mul(product.data(), x, xn, y, yn);
+    if (subtract) {
+      borrow = sub_1(r + xn + yn, n - xn - yn, sub(r, r, xn + yn, product.data(), xn + yn));
+    } else {
+      add_1(r + xn + yn, n - xn - yn, add(r, r, xn + yn, product.data(), xn + yn));
+    }
+  }
+  // the magnitude went below zero and is left in two's complement
+  if (borrow) {
+    negate_n(r, n);
+    sign = !sign;
+  }
+  shrink();
+}
+
+big_integer& addmul(big_integer& acc, const big_integer& b, const big_integer& c) {
+  if (&acc == &b || &acc == &c) {
+    big_integer factor = acc;
+    return addmul(acc, &acc == &b ? factor : b, &acc == &c ? factor : c);
+  }
+  acc.add_product(b, c.data.data(), c.data.size(), c.sign);
+  return acc;
+}
+
+big_integer& submul(big_integer& acc, const big_integer& b, const big_integer& c) {
+  if (&acc == &b || &acc == &c) {
+    big_integer factor = acc;
+    return submul(acc, &acc == &b ? factor : b, &acc == &c ? factor : c);
+  }
+  acc.add_product(b, c.data.data(), c.data.size(), !c.sign);
+  return acc;
+}
+
+big_integer& mul_add_digit(big_integer& acc, const big_integer& b, big_integer::digit d) {
+  if (&acc == &b) {
+    big_integer factor = acc;
+    return mul_add_digit(acc, factor, d);
+  }
+  acc.add_product(b, &d, d != 0, false);
+  return acc;
+}
+
+big_integer& big_integer::operator+=(const big_integer_product& rhs) {
+  return addmul(*this, rhs.lhs(), rhs.rhs());
+}
+
+big_integer& big_integer::operator-=(const big_integer_product& rhs) {
+  return submul(*this, rhs.lhs(), rhs.rhs());
+}
+
+big_integer::digit big_integer::to_digit() const {
+  return get(0);
+}
+
+big_integer::digit big_integer::div_digit(digit rhs) {
+  assert(rhs != 0);
+  digit reminder = divrem_1(data.data(), data.size(), rhs);
+  shrink();
+  return reminder;
+}
+
+divisor::divisor(digit d) : _value(d), _shift(std::countl_zero(d)) {
+  assert(d != 0);
+  _inverse = reciprocal_of(d << _shift);
+}
+
+big_integer::digit divisor::value() const noexcept {
+  return _value;
+}
+
+big_integer& big_integer::operator/=(const divisor& rhs) {
+  BIGINT_PROBE(DIV, data.size(), 1);
+  divrem_1_preinv(data.data(), data.size(), rhs._value << rhs._shift, rhs._inverse, rhs._shift);
+  shrink();
+  return *this;
+}
+
+big_integer& big_integer::operator%=(const divisor& rhs) {
+  BIGINT_PROBE(MOD, data.size(), 1);
+  digit reminder = divrem_1_preinv(data.data(), data.size(), rhs._value << rhs._shift, rhs._inverse, rhs._shift);
+  data.clear();
+  if (reminder != 0) {
+    data.push_back(reminder);
+  }
+  return *this;
+}
+
+std::pair<big_integer, big_integer> div(const big_integer& x, const big_integer& y) {
+  BIGINT_PROBE(DIV, x.data.size(), y.data.size());
+  assert(!y.is_zero());
+  size_t n = x.data.size();
+  size_t m = y.data.size();
+  std::pair<big_integer, big_integer> res;
+  if (m > n) {
+    res.second = x;
+  } else if (m == 1) {
+    res.first = x;
+    res.second = res.first.div_digit(y.to_digit());
+  } else {
+    res.first.data.resize(n - m + 1);
+    res.second.data.reserve(n + 1);
+    res.second.data = x.data;
+    res.second.data.push_back(0);
+    divrem(res.first.data.data(), res.second.data.data(), n, y.data.data(), m);
+    res.second.data.resize(m);
+    res.first.shrink();
+    res.second.shrink();
+  }
+  res.first.sign = x.sign ^ y.sign;
+  res.second.sign = x.sign;
+  return res;
+}
+
+big_integer& big_integer::operator/=(const big_integer& rhs) {
+  BIGINT_PROBE(DIV, data.size(), rhs.data.size());
+  *this = div(*this, rhs).first;
+  return *this;
+}
+
+big_integer& big_integer::operator%=(const big_integer& rhs) {
+  BIGINT_PROBE(MOD, data.size(), rhs.data.size());
+  *this = div(*this, rhs).second;
+  return *this;
+}
+
+namespace {
+// r[0, n) = t[0, 2n) / BASE^n mod m for t < m * BASE^n, destroys t
+void montgomery_reduce(digit* r, digit* t, const digit* m, size_t n, digit inv) {
+  // the carry out of step i belongs to t[i + n], it is kept in the zeroed t[i] and added at the end
+  for (size_t i = 0; i < n; ++i) {
+    t[i] = addmul_1(t + i, m, n, t[i] * inv);
+  }
+  if (add(r, t + n, n, t, n) != 0 || cmp(r, n, m, n) >= 0) {
+    sub(r, r, n, m, n);
+  }
+}
+
+size_t montgomery_scratch(size_t n) {
+  return 2 * n + std::max(mul_scratch<false>(n), mul_scratch<true>(n));
+}
+
+// r[0, n) = a * b / BASE^n mod m, r may coincide with a or b; scratch has montgomery_scratch(n) digits
+void montgomery_mul(digit* r, const digit* a, const digit* b, const digit* m, size_t n, digit inv,
+                    digit* scratch) {
+  if (a == b) {
+    mul_n<true>(scratch, a, a, n, scratch + 2 * n);
+  } else {
+    mul_n<false>(scratch, a, b, n, scratch + 2 * n);
+  }
+  montgomery_reduce(r, scratch, m, n, inv);
+}
+
+// sliding window width for an exponent of the given length, the table holds 2^(width - 1) odd powers
+size_t pow_window(size_t bits) {
+  size_t width = 1;
+  for (size_t limit : {24, 80, 240, 672, 1792}) {
+    width += bits > limit;
+  }
+  return width;
+}
+} // namespace
+
+montgomery_context::montgomery_context(const big_integer& mod) : _mod(mod) {
+  assert(mod.is_positive() && (mod.data[0] & 1) && "montgomery form needs a positive odd modulus");
+  // Newton's iteration doubles the number of correct low bits, m * m == 1 modulo 8 for odd m
+  digit m0 = mod.data[0];
+  digit inv = m0;
+  for (size_t bits = 3; bits < DIGIT_LEN; bits *= 2) {
+    inv *= 2 - m0 * inv;
+  }
+  _inv = -inv;
+  _r2 = (big_integer(1) << static_cast<int>(2 * mod.data.size() * DIGIT_LEN)) % mod;
+}
+
+const big_integer& montgomery_context::mod() const {
+  return _mod;
+}
+
+big_integer montgomery_context::to_form(const big_integer& a) const {
+  big_integer x = a % _mod;
+  if (x.is_negative()) {
+    x += _mod;
+  }
+  return mul(x, _r2);
+}
+
+big_integer montgomery_context::from_form(const big_integer& a) const {
+  return mul(a, 1);
+}
+
+big_integer montgomery_context::mul(const big_integer& a, const big_integer& b) const {
+  assert(unsigned_less(a, _mod) && unsigned_less(b, _mod));
+  size_t n = _mod.data.size();
+  digit_vector buffer(2 * n + montgomery_scratch(n));
+  digit* x = buffer.data();
+  digit* y = x + n;
+  std::copy(a.data.begin(), a.data.end(), x);
+  std::copy(b.data.begin(), b.data.end(), y);
+  big_integer res;
+  res.data.resize(n);
+  montgomery_mul(res.data.data(), x, y, _mod.data.data(), n, _inv, y + n);
+  res.shrink();
+  return res;
+}
+
+big_integer montgomery_context::pow(const big_integer& base, const big_integer& exp) const {
+  assert(!exp.is_negative());
+  if (exp.is_zero()) {
+    return big_integer(1) % _mod;
+  }
+  size_t n = _mod.data.size();
+  const digit* m = _mod.data.data();
+  size_t bits = exp.data.size() * DIGIT_LEN - std::countl_zero(exp.data.back());
+  size_t width = pow_window(bits);
+  size_t powers = size_t(1) << (width - 1);
+
+  // odd powers of the base, the accumulator and the square of the base share one buffer,
+  // nothing is allocated inside the loop
+  digit_vector buffer((powers + 2) * n + montgomery_scratch(n));
+  digit* table = buffer.data();
+  digit* x = table + powers * n;
+  digit* sq = x + n;
+  digit* scratch = sq + n;
+
+  big_integer g = to_form(base);
+  std::copy(g.data.begin(), g.data.end(), table);
+  if (powers > 1) {
+    montgomery_mul(sq, table, table, m, n, _inv, scratch);
+    for (size_t i = 1; i < powers; ++i) {
+      montgomery_mul(table + i * n, table + (i - 1) * n, sq, m, n, _inv, scratch);
+    }
+  }
+
+  auto bit = [&exp](size_t i) -> size_t { return (exp.data[i / DIGIT_LEN] >> (i % DIGIT_LEN)) & 1; };
+  // the highest bit is set, so the first window initializes x before any zero bit is squared in
+  bool started = false;
+  for (size_t i = bits; i > 0;) {
+    if (!bit(i - 1)) {
+      montgomery_mul(x, x, x, m, n, _inv, scratch);
+      --i;
+      continue;
+    }
+    size_t len = std::min(width, i);
+    while (!bit(i - len)) {
+      --len;
+    }
+    size_t value = 0;
+    for (size_t j = i; j > i - len; --j) {
+      value = value * 2 + bit(j - 1);
+    }
+    const digit* power = table + value / 2 * n;
+    if (started) {
+      for (size_t j = 0; j < len; ++j) {
+        montgomery_mul(x, x, x, m, n, _inv, scratch);
+      }
+      montgomery_mul(x, x, power, m, n, _inv, scratch);
+    } else {
+      std::copy(power, power + n, x);
+      started = true;
+    }
+    i -= len;
+  }
+
+  // leaving the form is a reduction of x itself
+  std::copy(x, x + n, scratch);
+  std::fill(scratch + n, scratch + 2 * n, 0);
+  big_integer res;
+  res.data.resize(n);
+  montgomery_reduce(res.data.data(), scratch, m, n, _inv);
+  res.shrink();
+  return res;
+}
+
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod) {
+  BIGINT_PROBE(POW_MOD, mod.data.size(), exp.data.size());
+  assert(!mod.is_zero() && !exp.is_negative());
+  big_integer m = mod;
+  m.sign = false;
+  if (m.data[0] & 1) {
+    return montgomery_context(m).pow(base, exp);
+  }
+  // even moduli are rare enough for plain binary exponentiation with division
+  big_integer b = base % m;
+  if (b.is_negative()) {
+    b += m;
+  }
+  big_integer res = big_integer(1) % m;
+  for (size_t i = exp.data.size() * DIGIT_LEN; i-- > 0;) {
+    res = res * res % m;
+    if ((exp.data[i / DIGIT_LEN] >> (i % DIGIT_LEN)) & 1) {
+      res = res * b % m;
+    }
+  }
+  return res;
+}
+
+namespace {
+// The gcd routines below work on natural numbers kept in digit_vectors without leading zero digits.
+
+void shrink_vec(digit_vector& a) {
+  while (!a.empty() && a.back() == 0) {
+    a.pop_back();
+  }
+}
+
+int cmp_vec(const digit_vector& a, const digit_vector& b) {
+  if (a.size() != b.size()) {
+    return a.size() < b.size() ? -1 : 1;
+  }
+  return cmp(a.data(), a.size(), b.data(), b.size());
+}
+
+// r += a
+void add_vec(digit_vector& r, const digit_vector& a) {
+  if (r.size() < a.size()) {
+    r.resize(a.size());
+  }
+  if (add(r.data(), r.data(), r.size(), a.data(), a.size()) != 0) {
+    r.push_back(1);
+  }
+}
+
+// r -= a for r >= a
+void sub_vec(digit_vector& r, const digit_vector& a) {
+  [[maybe_unused]] digit borrow = sub(r.data(), r.data(), r.size(), a.data(), a.size());
+  assert(borrow == 0);
+  shrink_vec(r);
+}
+
+// r += a * b, a and b must not refer to r
+void addmul_vec(digit_vector& r, const digit_vector& a, const digit_vector& b) {
+  if (a.empty() || b.empty()) {
+    return;
+  }
+  digit_vector prod(a.size() + b.size());
+  if (a.size() >= b.size()) {
+    mul(prod.data(), a.data(), a.size(), b.data(), b.size());
+  } else {
+    mul(prod.data(), b.data(), b.size(), a.data(), a.size());
+  }
+  shrink_vec(prod);
+  add_vec(r, prod);
+}
+
+// a = a mod b with the quotient in q, a >= b > 0
+void divrem_vec(digit_vector& q, digit_vector& a, const digit_vector& b) {
+  if (b.size() == 1) {
+    q = a;
+    digit r = divrem_1(q.data(), q.size(), b[0]);
+    a.clear();
+    if (r != 0) {
+      a.push_back(r);
+    }
+  } else {
+    size_t an = a.size();
+    q.resize(an - b.size() + 1);
+    a.push_back(0);
+    divrem(q.data(), a.data(), an, b.data(), b.size());
+    a.resize(b.size());
+    shrink_vec(a);
+  }
+  shrink_vec(q);
+}
+
+// (a; b) = m * (u; v) for the pair (a, b) a reduction started from and the current pair (u, v). The entries
+// are natural numbers and det m = 1, so gcd(u, v) = gcd(a, b). Only the rows from `first` on are kept:
+// the half gcd needs both, the extended gcd only the second one, which holds the cofactors of a.
+struct gcd_matrix {
+  explicit gcd_matrix(size_t first) : first(first) {
+    m[0][0].push_back(1);
+    m[1][1].push_back(1);
+  }
+
+  size_t first;
+  digit_vector m[2][2];
+};
+
+// m = m * s for a matrix s of digits
+void mul_matrix(gcd_matrix& m, const digit (&s)[2][2]) {
+  for (size_t i = m.first; i < 2; ++i) {
+    digit_vector& x = m.m[i][0];
+    digit_vector& y = m.m[i][1];
+    size_t n = std::max(x.size(), y.size());
+    x.resize(n);
+    y.resize(n);
+    digit_vector r[2];
+    for (size_t j = 0; j < 2; ++j) {
+      r[j].resize(n + 1);
+      r[j][n] = mul_1(r[j].data(), x.data(), n, s[0][j]);
+      r[j][n] += addmul_1(r[j].data(), y.data(), n, s[1][j]);
+      shrink_vec(r[j]);
+    }
+    x = std::move(r[0]);
+    y = std::move(r[1]);
+  }
+}
+
+// m = m * s
+void mul_matrix(gcd_matrix& m, const gcd_matrix& s) {
+  for (size_t i = m.first; i < 2; ++i) {
+    digit_vector r[2];
+    for (size_t j = 0; j < 2; ++j) {
+      addmul_vec(r[j], m.m[i][0], s.m[0][j]);
+      addmul_vec(r[j], m.m[i][1], s.m[1][j]);
+    }
+    m.m[i][0] = std::move(r[0]);
+    m.m[i][1] = std::move(r[1]);
+  }
+}
+
+// floor(a / 2^k) for a quotient that fits in a double digit
+double_digit high_bits(const digit_vector& a, size_t k) {
+  size_t i = k / DIGIT_LEN;
+  size_t shift = k % DIGIT_LEN;
+  auto at = [&a](size_t j) { return j < a.size() ? static_cast<double_digit>(a[j]) : 0; };
+  double_digit res = (at(i) | at(i + 1) << DIGIT_LEN) >> shift;
+  if (shift != 0) {
+    res |= at(i + 2) << (2 * DIGIT_LEN - shift);
+  }
+  return res;
+}
+
+// Lehmer's step: Euclid on the top 2 * DIGIT_LEN - 1 bits (x, y) of the pair gives s with (x; y) = s * (x'; y')
+// and x', y' >= BASE. Then the entries of s are below BASE / 2, less than x' and y', so the same s reduces
+// the whole pair to positive numbers. Returns false if not a single subtraction keeps both above BASE.
+bool lehmer_matrix(const digit_vector (&p)[2], digit (&s)[2][2]) {
+  auto bit_length = [](const digit_vector& a) { return a.size() * DIGIT_LEN - std::countl_zero(a.back()); };
+  size_t bits = std::max(bit_length(p[0]), bit_length(p[1]));
+  size_t k = bits > 2 * DIGIT_LEN - 1 ? bits - (2 * DIGIT_LEN - 1) : 0;
+  double_digit x[2] = {high_bits(p[0], k), high_bits(p[1], k)};
+  const double_digit limit = static_cast<double_digit>(1) << DIGIT_LEN;
+  double_digit t[2][2] = {{1, 0}, {0, 1}};
+  bool reduced = false;
+  while (true) {
+    // the larger one is reduced by the largest multiple of the smaller that leaves it above the limit
+    size_t j = x[0] >= x[1] ? 0 : 1;
+    if (x[1 - j] < limit) {
+      break;
+    }
+    double_digit q = (x[j] - limit) / x[1 - j];
+    if (q == 0) {
+      break;
+    }
+    x[j] -= q * x[1 - j];
+    t[0][1 - j] += q * t[0][j];
+    t[1][1 - j] += q * t[1][j];
+    reduced = true;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      s[i][j] = static_cast<digit>(t[i][j]);
+    }
+  }
+  return reduced;
+}
+
+// r = s^(-1) * p = (s11 * p0 - s01 * p1; s00 * p1 - s10 * p0) for s from lehmer_matrix
+void lehmer_apply(digit_vector (&r)[2], digit_vector (&p)[2], const digit (&s)[2][2]) {
+  size_t n = std::max(p[0].size(), p[1].size());
+  for (size_t j = 0; j < 2; ++j) {
+    p[j].resize(n);
+    r[j].resize(n);
+  }
+  for (size_t j = 0; j < 2; ++j) {
+    [[maybe_unused]] digit top = mul_1(r[j].data(), p[j].data(), n, s[1 - j][1 - j]);
+    top -= submul_1(r[j].data(), p[1 - j].data(), n, s[j][1 - j]);
+    assert(top == 0);
+    shrink_vec(r[j]);
+  }
+  shrink_vec(p[0]);
+  shrink_vec(p[1]);
+}
+
+// the larger number of the pair is reduced by the largest multiple of the smaller one that leaves it at least
+// min_size digits long, returns false if there is no such multiple
+bool div_step(digit_vector (&p)[2], gcd_matrix& m, size_t min_size) {
+  size_t j = cmp_vec(p[0], p[1]) >= 0 ? 0 : 1;
+  digit_vector& a = p[j];
+  const digit_vector& b = p[1 - j];
+  digit_vector q;
+  divrem_vec(q, a, b);
+  if (a.size() < min_size) {
+    // the remainder plus b is long enough, as b itself is
+    sub_1(q.data(), q.size(), 1);
+    shrink_vec(q);
+    add_vec(a, b);
+    if (q.empty()) {
+      return false;
+    }
+  }
+  for (size_t i = m.first; i < 2; ++i) {
+    addmul_vec(m.m[i][1 - j], m.m[i][j], q);
+  }
+  return true;
+}
+
+// one reduction step that keeps both numbers of the pair at least min_size digits long: Lehmer's step if the
+// top digits allow it and the result is long enough, otherwise a division; returns false if there is none
+bool gcd_step(digit_vector (&p)[2], gcd_matrix& m, size_t min_size, digit_vector (&scratch)[2]) {
+  digit s[2][2];
+  if (lehmer_matrix(p, s)) {
+    lehmer_apply(scratch, p, s);
+    if (scratch[0].size() >= min_size && scratch[1].size() >= min_size) {
+      std::swap(p, scratch);
+      mul_matrix(m, s);
+      return true;
+    }
+  }
+  return div_step(p, m, min_size);
+}
+
+bool hgcd(digit_vector (&p)[2], gcd_matrix& m, digit_vector (&scratch)[2]);
+
+// reduces the pair by the half gcd m of its digits above the lowest `low` ones: the top digits are reduced
+// by the recursion, and p = m^(-1) * p only has to be applied to the low ones, e.g.
+// p0 = top0 * BASE^low + m11 * low0 - m01 * low1. m must be the identity, returns false if it stays one
+bool hgcd_top(digit_vector (&p)[2], size_t low, gcd_matrix& m, digit_vector (&scratch)[2]) {
+  digit_vector top[2];
+  digit_vector rest[2];
+  for (size_t j = 0; j < 2; ++j) {
+    size_t len = std::min(low, p[j].size());
+    top[j].assign(p[j].begin() + len, p[j].end());
+    rest[j].assign(p[j].begin(), p[j].begin() + len);
+    shrink_vec(rest[j]);
+  }
+  if (!hgcd(top, m, scratch)) {
+    return false;
+  }
+  for (size_t j = 0; j < 2; ++j) {
+    digit_vector& r = p[j];
+    r.clear();
+    r.resize(low + top[j].size());
+    std::copy(top[j].begin(), top[j].end(), r.begin() + low);
+    addmul_vec(r, m.m[1 - j][1 - j], rest[j]);
+    digit_vector sub;
+    addmul_vec(sub, m.m[j][1 - j], rest[1 - j]);
+    sub_vec(r, sub);
+  }
+  return true;
+}
+
+// Half gcd: reduces the pair of at most n digits by m (the identity on entry) while both numbers stay at least
+// s + 1 digits long for s = n / 2 + 1. The entries of m then have at most n - s digits, which keeps the
+// reduction valid for the pair extended by any lower digits, see hgcd_top. Above the threshold the top half
+// is reduced recursively first, then the top of what is left, Lehmer's steps finish the job.
+// Returns false if not a single step was possible.
+bool hgcd(digit_vector (&p)[2], gcd_matrix& m, digit_vector (&scratch)[2]) {
+  size_t n = std::max(p[0].size(), p[1].size());
+  size_t s = n / 2 + 1;
+  if (std::min(p[0].size(), p[1].size()) <= s) {
+    return false;
+  }
+  bool reduced = false;
+  if (n >= HGCD_THRESHOLD) {
+    reduced = hgcd_top(p, n / 2, m, scratch);
+    while (std::max(p[0].size(), p[1].size()) > 3 * n / 4 + 1) {
+      if (!gcd_step(p, m, s + 1, scratch)) {
+        return reduced;
+      }
+      reduced = true;
+    }
+    size_t k = std::max(p[0].size(), p[1].size());
+    if (k > s + 2) {
+      gcd_matrix next(0);
+      if (hgcd_top(p, 2 * s - k + 1, next, scratch)) {
+        mul_matrix(m, next);
+        reduced = true;
+      }
+    }
+  }
+  while (gcd_step(p, m, s + 1, scratch)) {
+    reduced = true;
+  }
+  return reduced;
+}
+
+// binary gcd of single digits
+digit gcd_digit(digit a, digit b) {
+  if (a == 0 || b == 0) {
+    return a | b;
+  }
+  int shift = std::countr_zero(a | b);
+  a >>= std::countr_zero(a);
+  do {
+    b >>= std::countr_zero(b);
+    if (a > b) {
+      std::swap(a, b);
+    }
+    b -= a;
+  } while (b != 0);
+  return a << shift;
+}
+
+double_digit gcd_double(double_digit a, double_digit b) {
+  while (a > MAX_DIGIT || b > MAX_DIGIT) {
+    if (b == 0) {
+      return a;
+    }
+    a %= b;
+    std::swap(a, b);
+  }
+  return gcd_digit(static_cast<digit>(a), static_cast<digit>(b));
+}
+
+// reduces the pair to (g, 0) or (0, g) and returns the index of g, m follows the reduction
+size_t gcd_reduce(digit_vector (&p)[2], gcd_matrix& m) {
+  digit_vector scratch[2];
+  while (!p[0].empty() && !p[1].empty()) {
+    size_t n = std::max(p[0].size(), p[1].size());
+    if (m.first == 2 && n <= 2) {
+      // without cofactors to follow, the tail fits in double digits
+      double_digit g = gcd_double(high_bits(p[0], 0), high_bits(p[1], 0));
+      p[0].resize(2);
+      p[0][0] = static_cast<digit>(g);
+      p[0][1] = static_cast<digit>(g >> DIGIT_LEN);
+      shrink_vec(p[0]);
+      p[1].clear();
+      break;
+    }
+    if (std::min(p[0].size(), p[1].size()) >= HGCD_THRESHOLD) {
+      // the half gcd of the top half takes a quarter off both numbers
+      gcd_matrix h(0);
+      if (hgcd_top(p, n / 2, h, scratch)) {
+        mul_matrix(m, h);
+        continue;
+      }
+    }
+    gcd_step(p, m, 0, scratch);
+  }
+  return p[0].empty() ? 1 : 0;
+}
+} // namespace
+
+big_integer gcd(const big_integer& a, const big_integer& b) {
+  BIGINT_PROBE(GCD, a.data.size(), b.data.size());
+  digit_vector p[2] = {a.data, b.data};
+  gcd_matrix m(2);
+  big_integer res;
+  res.data = std::move(p[gcd_reduce(p, m)]);
+  return res;
+}
+
+std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b) {
+  digit_vector p[2] = {a.data, b.data};
+  gcd_matrix m(1);
+  size_t j = gcd_reduce(p, m);
+  std::tuple<big_integer, big_integer, big_integer> res;
+  auto& [g, x, y] = res;
+  g.data = std::move(p[j]);
+  // |a| * m11 - |b| * m01 = u and -|a| * m10 + |b| * m00 = v
+  x.data = std::move(m.m[1][1 - j]);
+  x.sign = (j == 1) != a.sign;
+  if (!b.is_zero()) {
+    y = (g - a * x) / b;
+  }
+  return res;
+}
+
+big_integer mod_inverse(const big_integer& a, const big_integer& mod) {
+  assert(!mod.is_zero());
+  big_integer m = mod;
+  m.sign = false;
+  big_integer r = a % m;
+  if (r.is_negative()) {
+    r += m;
+  }
+  digit_vector p[2] = {r.data, m.data};
+  gcd_matrix c(1);
+  size_t j = gcd_reduce(p, c);
+  if (p[j].size() != 1 || p[j][0] != 1) {
+    return 0;
+  }
+  big_integer res;
+  res.data = std::move(c.m[1][1 - j]);
+  res.sign = j == 1;
+  res %= m;
+  if (res.is_negative()) {
+    res += m;
+  }
+  return res;
+}
+
+namespace {
+// The roots below work on the natural numbers of the gcd routines.
+
+size_t bit_length(const digit_vector& a) {
+  return a.empty() ? 0 : a.size() * DIGIT_LEN - std::countl_zero(a.back());
+}
+
+// a * 2^k
+digit_vector shl_vec(const digit_vector& a, size_t k) {
+  if (a.empty()) {
+    return {};
+  }
+  size_t digits = k / DIGIT_LEN;
+  digit_vector r(digits + a.size() + 1);
+  if (k % DIGIT_LEN == 0) {
+    std::copy(a.begin(), a.end(), r.begin() + digits);
+  } else {
+    r.back() = lshift(r.data() + digits, a.data(), a.size(), k % DIGIT_LEN);
+  }
+  shrink_vec(r);
+  return r;
+}
+
+// floor(a / 2^k)
+digit_vector shr_vec(const digit_vector& a, size_t k) {
+  size_t digits = k / DIGIT_LEN;
+  if (digits >= a.size()) {
+    return {};
+  }
+  digit_vector r(a.begin() + digits, a.end());
+  if (k % DIGIT_LEN != 0) {
+    rshift(r.data(), r.data(), r.size(), k % DIGIT_LEN);
+  }
+  shrink_vec(r);
+  return r;
+}
+
+digit_vector sqr_vec(const digit_vector& a) {
+  digit_vector r(2 * a.size());
+  if (!a.empty()) {
+    sqr(r.data(), a.data(), a.size());
+  }
+  shrink_vec(r);
+  return r;
+}
+
+// a^e for e > 0
+digit_vector pow_vec(const digit_vector& a, unsigned e) {
+  digit_vector r = a;
+  for (int i = std::bit_width(e) - 2; i >= 0; --i) {
+    r = sqr_vec(r);
+    if ((e >> i) & 1) {
+      digit_vector t;
+      addmul_vec(t, r, a);
+      r = std::move(t);
+    }
+  }
+  return r;
+}
+
+// s = floor(sqrt(a)) and a = a - s^2 for a of at most four digits by Newton's iteration from above
+void sqrtrem_basecase(digit_vector& s, digit_vector& a) {
+  s = shl_vec({1}, (bit_length(a) + 1) / 2);
+  while (true) {
+    digit_vector r = a, q;
+    if (cmp_vec(r, s) >= 0) {
+      divrem_vec(q, r, s);
+    }
+    add_vec(q, s);
+    q = shr_vec(q, 1);
+    if (cmp_vec(q, s) >= 0) {
+      break;
+    }
+    s = std::move(q);
+  }
+  sub_vec(a, sqr_vec(s));
+}
+
+// s = floor(sqrt(a)) and a = a - s^2 for a whose top digit is at least BASE / 4, by Zimmermann's Karatsuba square
+// root: for a = a3 * B^3 + a2 * B^2 + a1 * B + a0 and the root s' of a3 * B + a2 with the remainder r', the
+// quotient q = (r' * B + a1) / 2s' gives s = s' * B + q up to a single correction. Only the top half of the digits
+// is rooted recursively and the division is a quarter of them by another quarter.
+void sqrtrem(digit_vector& s, digit_vector& a) {
+  size_t l = (a.size() - 1) / 4;
+  if (l == 0) {
+    sqrtrem_basecase(s, a);
+    return;
+  }
+  digit_vector r(a.begin() + 2 * l, a.end());
+  digit_vector root;
+  sqrtrem(root, r);
+  // u = r' * B + a1
+  digit_vector u(l + r.size());
+  std::copy(a.begin() + l, a.begin() + 2 * l, u.begin());
+  std::copy(r.begin(), r.end(), u.begin() + l);
+  shrink_vec(u);
+  digit_vector q;
+  digit_vector twice = shl_vec(root, 1);
+  if (cmp_vec(u, twice) >= 0) {
+    divrem_vec(q, u, twice);
+  }
+  s = shl_vec(root, l * DIGIT_LEN);
+  add_vec(s, q);
+  // a - s^2 = u * B + a0 - q^2
+  r.assign(a.begin(), a.begin() + l);
+  r.resize(l + u.size());
+  std::copy(u.begin(), u.end(), r.begin() + l);
+  shrink_vec(r);
+  digit_vector q2 = sqr_vec(q);
+  if (cmp_vec(r, q2) >= 0) {
+    sub_vec(r, q2);
+  } else {
+    // (s - 1)^2 = s^2 - (2s - 1)
+    sub_vec(q2, r);
+    r = shl_vec(s, 1);
+    sub_vec(r, {1});
+    sub_vec(r, q2);
+    sub_vec(s, {1});
+  }
+  a = std::move(r);
+}
+
+// floor(a^(1/k)) for a of the given bit length and k >= 2. Newton's iteration x = ((k - 1) * x + a / x^(k - 1)) / k
+// decreases from any x above the root down to it. It is started from the root of the top half of the bits, which
+// leaves only the lower half of the root to the steps at full length, usually two of them.
+digit_vector root_vec(const digit_vector& a, unsigned k, size_t bits) {
+  digit_vector x;
+  size_t t = bits / (2 * k);
+  if (t == 0) {
+    x = shl_vec({1}, (bits + k - 1) / k);
+  } else {
+    // a / 2^kt < (s + 1)^k for the root s of the top bits
+    x = root_vec(shr_vec(a, k * t), k, bits - k * t);
+    add_vec(x, {1});
+    x = shl_vec(x, t);
+  }
+  while (true) {
+    digit_vector p = pow_vec(x, k - 1);
+    // x is never below the root, so x^k <= a means it is the root, which is cheaper to see than the step
+    digit_vector r;
+    addmul_vec(r, x, p);
+    if (cmp_vec(r, a) <= 0) {
+      return x;
+    }
+    r = a;
+    digit_vector q;
+    if (cmp_vec(r, p) >= 0) {
+      divrem_vec(q, r, p);
+    }
+    digit_vector y(x.size() + 1);
+    y.back() = mul_1(y.data(), x.data(), x.size(), k - 1);
+    shrink_vec(y);
+    add_vec(y, q);
+    divrem_1(y.data(), y.size(), k);
+    shrink_vec(y);
+    x = std::move(y);
+  }
+}
+} // namespace
+
+big_integer isqrt(const big_integer& a) {
+  assert(!a.is_negative());
+  big_integer res;
+  if (a.is_zero()) {
+    return res;
+  }
+  // the root of a * 4^c with a normalized top digit is the root of a times 2^c
+  size_t c = std::countl_zero(a.data.back()) / 2;
+  digit_vector m = shl_vec(a.data, 2 * c);
+  sqrtrem(res.data, m);
+  res.data = shr_vec(res.data, c);
+  return res;
+}
+
+big_integer iroot(const big_integer& a, unsigned k) {
+  assert(k > 0 && (k % 2 == 1 || !a.is_negative()));
+  if (k == 1) {
+    return a;
+  }
+  if (k == 2 || a.is_zero()) {
+    return isqrt(a);
+  }
+  big_integer res;
+  size_t bits = bit_length(a.data);
+  res.data = bits <= k ? digit_vector{1} : root_vec(a.data, k, bits);
+  res.sign = a.sign;
+  return res;
+}
+
+namespace {
+// Factorials, binomials and primorials are products of many small factors, multiplied out by product trees.
+
+// primes up to n by the sieve of Eratosthenes on odd numbers
+std::vector<digit> primes_up_to(digit n) {
+  std::vector<digit> primes;
+  if (n < 2) {
+    return primes;
+  }
+  primes.push_back(2);
+  // composite[i] is about 2i + 1
+  std::vector<bool> composite(n / 2 + 1);
+  for (size_t i = 1; 2 * i + 1 <= n; ++i) {
+    if (composite[i]) {
+      continue;
+    }
+    size_t p = 2 * i + 1;
+    primes.push_back(static_cast<digit>(p));
+    for (size_t j = p * p; j <= n; j += 2 * p) {
+      composite[j / 2] = true;
+    }
+  }
+  return primes;
+}
+
+// small factors packed into digits as long as their product fits, the leaves of a product tree
+struct factor_digits {
+  void push(digit f) {
+    if (!digits.empty() && digits.back() <= MAX_DIGIT / f) {
+      digits.back() *= f;
+    } else {
+      digits.push_back(f);
+    }
+  }
+
+  std::vector<digit> digits;
+};
+
+// the product of the digits f[0, n), halves are multiplied recursively so that the factors of each
+// multiplication are about as long; with a parallel scope the halves of long products are tasks
+digit_vector product_tree(const digit* f, size_t n) {
+  if (n <= 16) {
+    digit_vector r{1};
+    for (size_t i = 0; i < n; ++i) {
+      digit carry = mul_1(r.data(), r.data(), r.size(), f[i]);
+      if (carry != 0) {
+        r.push_back(carry);
+      }
+    }
+    return r;
+  }
+  digit_vector left;
+  digit_vector right;
+  auto multiply_left = [&] { left = product_tree(f, n / 2); };
+  auto multiply_right = [&] { right = product_tree(f + n / 2, n - n / 2); };
+  if (parallel(n)) {
+    fork(multiply_left, multiply_right);
+  } else {
+    multiply_left();
+    multiply_right();
+  }
+  digit_vector r;
+  addmul_vec(r, left, right);
+  return r;
+}
+
+digit_vector product_tree(const factor_digits& f) {
+  return product_tree(f.digits.data(), f.digits.size());
+}
+
+// The odd part of the swing n! / ((n / 2)!)^2, a product of primes p with the exponent sum(floor(n / p^i) mod 2).
+// The power of p stays below n, so it fits in a digit.
+digit_vector odd_swing(digit n, const std::vector<digit>& primes) {
+  factor_digits f;
+  for (size_t i = 1; i < primes.size() && primes[i] <= n; ++i) {
+    digit p = primes[i];
+    digit power = 1;
+    for (digit q = n / p; q > 0; q /= p) {
+      if (q & 1) {
+        power *= p;
+      }
+    }
+    if (power > 1) {
+      f.push(power);
+    }
+  }
+  return product_tree(f);
+}
+
+// the odd part of n!, (n / 2)!^2 times the odd part of the swing of n
+digit_vector odd_factorial(digit n, const std::vector<digit>& primes) {
+  if (n < 3) {
+    return {1};
+  }
+  digit_vector half;
+  digit_vector swing;
+  auto factorial_half = [&] { half = odd_factorial(n / 2, primes); };
+  auto multiply_swing = [&] { swing = odd_swing(n, primes); };
+  if (parallel(n / DIGIT_LEN)) {
+    fork(factorial_half, multiply_swing);
+  } else {
+    factorial_half();
+    multiply_swing();
+  }
+  digit_vector r;
+  addmul_vec(r, sqr_vec(half), swing);
+  return r;
+}
+} // namespace
+
+big_integer factorial(big_integer::digit n) {
+  // the power of two in n! is n minus the number of ones in n
+  big_integer res;
+  res.data = shl_vec(odd_factorial(n, primes_up_to(n)), n - std::popcount(n));
+  return res;
+}
+
+big_integer binomial(big_integer::digit n, big_integer::digit k) {
+  big_integer res;
+  if (k > n) {
+    return res;
+  }
+  // by Kummer's theorem p divides the binomial as many times as there are borrows in n - k in base p
+  factor_digits f;
+  for (digit p : primes_up_to(n)) {
+    digit power = 1;
+    digit borrow = 0;
+    for (digit a = n, b = k; a > 0; a /= p, b /= p) {
+      borrow = a % p < b % p + borrow;
+      if (borrow) {
+        power *= p;
+      }
+    }
+    if (power > 1) {
+      f.push(power);
+    }
+  }
+  res.data = product_tree(f);
+  return res;
+}
+
+big_integer primorial(big_integer::digit n) {
+  factor_digits f;
+  for (digit p : primes_up_to(n)) {
+    f.push(p);
+  }
+  big_integer res;
+  res.data = product_tree(f);
+  return res;
+}
+
+// A negative operand with magnitude m is ~(m - 1) in two's complement, and a negative result with two's
+// complement t has magnitude ~t + 1. m - 1 differs from m only up to the lowest nonzero digit of m, so past
+// that digit the operation runs on the magnitudes themselves with the complements as xor masks.
+template <class BinaryOperation>
+big_integer& big_integer::binary(const big_integer& rhs, const BinaryOperation& op) {
+  bool a_sign = is_negative();
+  bool b_sign = rhs.is_negative();
+  size_t an = data.size();
+  size_t bn = rhs.data.size();
+  if (!a_sign && !b_sign) {
+    // no complements, a missing digit of the shorter operand is zero
+    bitwise_n(data.data(), data.data(), rhs.data.data(), std::min(an, bn), op, 0, 0, 0);
+    if (op(MAX_DIGIT, digit(0)) == 0) {
+      data.resize(std::min(an, bn));
+    } else if (an < bn) {
+      data.resize(bn);
+      std::copy(rhs.data.begin() + an, rhs.data.end(), data.begin() + an);
+    }
+    sign = false;
+    shrink();
+    return *this;
+  }
+  bool res_sign = op(a_sign, b_sign);
+  digit a_mask = a_sign ? MAX_DIGIT : 0;
+  digit b_mask = b_sign ? MAX_DIGIT : 0;
+  digit r_mask = res_sign ? MAX_DIGIT : 0;
+  size_t len = std::max(an, bn);
+  data.reserve(len + 1);
+  resize(len);
+  digit* r = data.data();
+  const digit* b = rhs.data.data();
+  size_t i = 0;
+  for (bool a_borrow = a_sign, b_borrow = b_sign; a_borrow || b_borrow; ++i) {
+    digit x = r[i] - a_borrow;
+    digit y = rhs.get(i) - b_borrow;
+    a_borrow = a_borrow && r[i] == 0;
+    b_borrow = b_borrow && rhs.get(i) == 0;
+    r[i] = op(x ^ a_mask, y ^ b_mask) ^ r_mask;
+  }
+  if (i < bn) {
+    bitwise_n(r + i, r + i, b + i, bn - i, op, a_mask, b_mask, r_mask);
+    i = bn;
+  }
+  bitwise_1(r + i, r + i, len - i, op, a_mask, b_mask, r_mask);
+  if (res_sign && add_1(r, len, 1)) {
+    data.push_back(1);
+  }
+  sign = res_sign;
+  shrink();
+  return *this;
+}
+
+big_integer& big_integer::operator&=(const big_integer& rhs) {
+  BIGINT_PROBE(AND, data.size(), rhs.data.size());
+  return binary(rhs, std::bit_and<>());
+}
+
+big_integer& big_integer::operator|=(const big_integer& rhs) {
+  BIGINT_PROBE(OR, data.size(), rhs.data.size());
+  return binary(rhs, std::bit_or<>());
+}
+
+big_integer& big_integer::operator^=(const big_integer& rhs) {
+  BIGINT_PROBE(XOR, data.size(), rhs.data.size());
+  return binary(rhs, std::bit_xor<>());
+}
+
+big_integer& big_integer::operator<<=(int rhs) {
+  assert(rhs >= 0);
+  BIGINT_PROBE(SHL, data.size(), rhs / DIGIT_LEN);
+  if (data.empty()) {
+    return *this;
+  }
+  size_t n = data.size();
+  size_t digits = rhs / DIGIT_LEN;
+  size_t bits = rhs % DIGIT_LEN;
+  data.reserve(n + digits + 1);
+  data.resize(n + digits);
+  digit* r = data.data();
+  std::copy_backward(r, r + n, r + n + digits);
+  std::fill(r, r + digits, 0);
+  if (bits != 0) {
+    digit rest = lshift(r + digits, r + digits, n, bits);
+    if (rest) {
+      data.push_back(rest);
+    }
+  }
+  return *this;
+}
+
+big_integer& big_integer::operator>>=(int rhs) {
+  assert(rhs >= 0);
+  BIGINT_PROBE(SHR, data.size(), rhs / DIGIT_LEN);
+  // negative numbers round towards minus infinity, so only they need to know whether the lost bits are zero
+  bool negative = is_negative();
+  bool round = false;
+  auto del_end = data.begin() + std::min(data.size(), static_cast<size_t>(rhs / DIGIT_LEN));
+  for (auto it2 = data.begin(); negative && it2 != del_end && !round; ++it2) {
+    round |= *it2;
+  }
+  data.erase(data.begin(), del_end);
+  rhs %= DIGIT_LEN;
+  if (rhs && !data.empty()) {
+    round |= rshift(data.data(), data.data(), data.size(), rhs) != 0;
+  }
+  if (negative && round) {
+    --(*this);
+  }
+  shrink();
+  return *this;
+}
+
+big_integer big_integer::operator+() const {
+  return *this;
+}
+
+big_integer big_integer::operator-() const& {
+  return -big_integer(*this);
+}
+
+big_integer big_integer::operator-() && {
+  return std::move(negate());
+}
+
+big_integer big_integer::operator~() const& {
+  return ~big_integer(*this);
+}
+
+big_integer big_integer::operator~() && {
+  ++(*this);
+  return std::move(negate());
+}
+
+big_integer& big_integer::operator++() {
+  if (sign) {
+    subtract_digit(1);
+  } else {
+    add_digit(1);
+  }
+  return *this;
+}
+
+big_integer big_integer::operator++(int) {
+  big_integer tmp = *this;
+  ++(*this);
+  return tmp;
+}
+
+big_integer& big_integer::operator--() {
+  negate();
+  ++(*this);
+  negate();
+  return *this;
+}
+
+big_integer big_integer::operator--(int) {
+  big_integer tmp = *this;
+  --(*this);
+  return tmp;
+}
+
+big_integer operator+(const big_integer& a, const big_integer& b) {
+  return big_integer(a) += b;
+}
+
+big_integer operator+(big_integer&& a, const big_integer& b) {
+  return std::move(a += b);
+}
+
+big_integer operator+(const big_integer& a, big_integer&& b) {
+  return std::move(b += a);
+}
+
+big_integer operator+(big_integer&& a, big_integer&& b) {
+  return std::move(a += b);
+}
+
+big_integer operator-(const big_integer& a, const big_integer& b) {
+  return big_integer(a) -= b;
+}
+
+big_integer operator-(big_integer&& a, const big_integer& b) {
+  return std::move(a -= b);
+}
+
+big_integer operator-(const big_integer& a, big_integer&& b) {
+  return -std::move(b -= a);
+}
+
+big_integer operator-(big_integer&& a, big_integer&& b) {
+  return std::move(a -= b);
+}
+
+big_integer operator+(const big_integer_product& a, const big_integer& b) {
+  return big_integer(b) += a;
+}
+
+big_integer operator+(const big_integer_product& a, big_integer&& b) {
+  return std::move(b += a);
+}
+
+big_integer operator+(const big_integer& a, const big_integer_product& b) {
+  return big_integer(a) += b;
+}
+
+big_integer operator+(big_integer&& a, const big_integer_product& b) {
+  return std::move(a += b);
+}
+
+big_integer operator+(const big_integer_product& a, const big_integer_product& b) {
+  return big_integer(a) += b;
+}
+
+big_integer operator-(const big_integer_product& a, const big_integer& b) {
+  return -std::move(big_integer(b) -= a);
+}
+
+big_integer operator-(const big_integer_product& a, big_integer&& b) {
+  return -std::move(b -= a);
+}
+
+big_integer operator-(const big_integer& a, const big_integer_product& b) {
+  return big_integer(a) -= b;
+}
+
+big_integer operator-(big_integer&& a, const big_integer_product& b) {
+  return std::move(a -= b);
+}
+
+big_integer operator-(const big_integer_product& a, const big_integer_product& b) {
+  return big_integer(a) -= b;
+}
+
+big_integer operator+(const big_integer_product& a) {
+  return a;
+}
+
+big_integer operator-(const big_integer_product& a) {
+  return -big_integer(a);
+}
+
+big_integer operator~(const big_integer_product& a) {
+  return ~big_integer(a);
+}
+
+big_integer operator/(const big_integer& a, const big_integer& b) {
+  return div(a, b).first;
+}
+
+big_integer operator%(const big_integer& a, const big_integer& b) {
+  return div(a, b).second;
+}
+
+big_integer operator/(big_integer a, const divisor& d) {
+  return a /= d;
+}
+
+big_integer operator%(big_integer a, const divisor& d) {
+  return a %= d;
+}
+
+big_integer operator&(const big_integer& a, const big_integer& b) {
+  return big_integer(a) &= b;
+}
+
+big_integer operator&(big_integer&& a, const big_integer& b) {
+  return std::move(a &= b);
+}
+
+big_integer operator&(const big_integer& a, big_integer&& b) {
+  return std::move(b &= a);
+}
+
+big_integer operator&(big_integer&& a, big_integer&& b) {
+  return std::move(a &= b);
+}
+
+big_integer operator|(const big_integer& a, const big_integer& b) {
+  return big_integer(a) |= b;
+}
+
+big_integer operator|(big_integer&& a, const big_integer& b) {
+  return std::move(a |= b);
+}
+
+big_integer operator|(const big_integer& a, big_integer&& b) {
+  return std::move(b |= a);
+}
+
+big_integer operator|(big_integer&& a, big_integer&& b) {
+  return std::move(a |= b);
+}
+
+big_integer operator^(const big_integer& a, const big_integer& b) {
+  return big_integer(a) ^= b;
+}
+
+big_integer operator^(big_integer&& a, const big_integer& b) {
+  return std::move(a ^= b);
+}
+
+big_integer operator^(const big_integer& a, big_integer&& b) {
+  return std::move(b ^= a);
+}
+
+big_integer operator^(big_integer&& a, big_integer&& b) {
+  return std::move(a ^= b);
+}
+
+big_integer operator<<(const big_integer& a, int b) {
+  return big_integer(a) <<= b;
+}
+
+big_integer operator<<(big_integer&& a, int b) {
+  return std::move(a <<= b);
+}
+
+big_integer operator>>(const big_integer& a, int b) {
+  return big_integer(a) >>= b;
+}
+
+big_integer operator>>(big_integer&& a, int b) {
+  return std::move(a >>= b);
+}
+
+bool operator==(const big_integer& a, const big_integer& b) {
+  return (a.is_zero() && b.is_zero()) || (a.sign == b.sign && a.data == b.data);
+}
+
+bool operator!=(const big_integer& a, const big_integer& b) {
+  return !(a == b);
+}
+
+bool operator<(const big_integer& a, const big_integer& b) {
+  if (a.is_zero() && b.is_zero()) {
+    return false;
+  }
+  if (a.sign != b.sign) {
+    return a.sign && !b.sign;
+  }
+  return a.sign ^ unsigned_less(a, b);
+}
+
+bool operator>(const big_integer& a, const big_integer& b) {
+  return b < a;
+}
+
+bool operator<=(const big_integer& a, const big_integer& b) {
+  return !(a > b);
+}
+
+bool operator>=(const big_integer& a, const big_integer& b) {
+  return !(a < b);
+}
+
+namespace {
+void strip(digit_vector& a) {
+  while (!a.empty() && a.back() == 0) {
+    a.pop_back();
+  }
+}
+
+// DEC_BASE normalized for divrem_1_preinv
+const unsigned DEC_SHIFT = std::countl_zero(DEC_BASE);
+const digit DEC_INVERSE = reciprocal_of(DEC_BASE << DEC_SHIFT);
+
+// powers[i] = DEC_BASE^(2^i), appends the next one
+void extend_dec_powers(std::vector<digit_vector>& powers) {
+  if (powers.empty()) {
+    powers.push_back({DEC_BASE});
+    return;
+  }
+  const digit_vector& last = powers.back();
+  digit_vector next(2 * last.size());
+  sqr(next.data(), last.data(), last.size());
+  strip(next);
+  powers.push_back(std::move(next));
+}
+
+// writes x with exactly width characters padded by zeros, x < DEC_BASE^(2^(level + 1)), width % DEC_DIGIT_LEN == 0;
+// x is split by powers[level] into halves converted independently
+void write_decimal(char* out, size_t width, digit_vector& x, size_t level, const std::vector<digit_vector>& powers) {
+  strip(x);
+  if (x.size() < TO_STRING_THRESHOLD) {
+    char* pos = out + width;
+    while (!x.empty()) {
+      digit rem = divrem_1_preinv(x.data(), x.size(), DEC_BASE << DEC_SHIFT, DEC_INVERSE, DEC_SHIFT);
+      strip(x);
+      for (size_t i = 0; i < DEC_DIGIT_LEN; ++i) {
+        *--pos = static_cast<char>('0' + rem % 10);
+        rem /= 10;
+      }
+    }
+    std::fill(out, pos, '0');
+    return;
+  }
+  assert(level > 0);
+  const digit_vector& p = powers[level];
+  if (x.size() < p.size() || (x.size() == p.size() && cmp(x.data(), x.size(), p.data(), p.size()) < 0)) {
+    write_decimal(out, width, x, level - 1, powers);
+    return;
+  }
+  size_t n = x.size();
+  digit_vector q(n - p.size() + 1);
+  x.push_back(0);
+  divrem(q.data(), x.data(), n, p.data(), p.size());
+  x.resize(p.size());
+  size_t low = DEC_DIGIT_LEN << level;
+  auto write_high = [&] { write_decimal(out, width - low, q, level - 1, powers); };
+  auto write_low = [&] { write_decimal(out + width - low, low, x, level - 1, powers); };
+  if (parallel(n)) {
+    fork(write_high, write_low);
+  } else {
+    write_high();
+    write_low();
+  }
+}
+
+// parses the decimal digits str[0, len), the lower DEC_DIGIT_LEN * 2^level characters are
+// converted separately and joined by a multiplication with powers[level]
+digit_vector parse_decimal(const char* str, size_t len, size_t level, const std::vector<digit_vector>& powers) {
+  digit_vector res;
+  if (len <= FROM_STRING_THRESHOLD * DEC_DIGIT_LEN) {
+    res.reserve(len / DEC_DIGIT_LEN + 1);
+    for (size_t begin = 0, chunk = (len - 1) % DEC_DIGIT_LEN + 1; begin < len; begin += chunk, chunk = DEC_DIGIT_LEN) {
+      digit val = 0;
+      for (size_t i = begin; i < begin + chunk; ++i) {
+        val = val * 10 + (str[i] - '0');
+      }
+      digit carry = mul_1(res.data(), res.data(), res.size(), POW10[chunk]);
+      if (carry != 0) {
+        res.push_back(carry);
+      }
+      if (res.empty()) {
+        res.push_back(0);
+      }
+      if (add(res.data(), res.data(), res.size(), &val, 1) != 0) {
+        res.push_back(1);
+      }
+    }
+    strip(res);
+    return res;
+  }
+  size_t low = DEC_DIGIT_LEN << level;
+  while (low >= len) {
+    low >>= 1;
+    --level;
+  }
+  digit_vector high_part;
+  digit_vector low_part;
+  auto parse_high = [&] { high_part = parse_decimal(str, len - low, level, powers); };
+  auto parse_low = [&] { low_part = parse_decimal(str + len - low, low, level, powers); };
+  if (parallel(len / DEC_DIGIT_LEN)) {
+    fork(parse_high, parse_low);
+  } else {
+    parse_high();
+    parse_low();
+  }
+  const digit_vector& p = powers[level];
+  if (high_part.empty()) {
+    return low_part;
+  }
+  res.resize(high_part.size() + p.size() + 1, 0);
+  if (high_part.size() >= p.size()) {
+    mul(res.data(), high_part.data(), high_part.size(), p.data(), p.size());
+  } else {
+    mul(res.data(), p.data(), p.size(), high_part.data(), high_part.size());
+  }
+  if (!low_part.empty()) {
+    add(res.data(), res.data(), res.size(), low_part.data(), low_part.size());
+  }
+  strip(res);
+  return res;
+}
+} // namespace
+
+namespace {
+const char RADIX_DIGITS[] = "0123456789abcdefghijklmnopqrstuv";
+
+// the value of a digit character of bases up to 32 in either case, 32 for other characters
+constexpr std::array<uint8_t, 256> RADIX_VALUES = [] {
+  std::array<uint8_t, 256> values{};
+  values.fill(32);
+  for (uint8_t i = 0; i < 32; ++i) {
+    values[static_cast<unsigned char>(RADIX_DIGITS[i])] = i;
+    if (i >= 10) {
+      values[static_cast<unsigned char>(RADIX_DIGITS[i] - 'a' + 'A')] = i;
+    }
+  }
+  return values;
+}();
+
+// log2 of a power of two base from 2 to 32, 0 for other bases
+size_t radix_bits(int base) {
+  if (base < 2 || base > 32 || !std::has_single_bit(static_cast<unsigned>(base))) {
+    return 0;
+  }
+  return std::countr_zero(static_cast<unsigned>(base));
+}
+
+[[noreturn]] void bad_symbol(const std::string& str, size_t i) {
+  if (str[i] == '+' || str[i] == '-' || isspace(str[i])) {
+    throw std::invalid_argument("no signs or spaces expected at position " + std::to_string(i));
+  }
+  throw std::invalid_argument("unknown symbols found at position " + std::to_string(i));
+}
+
+// the position after the sign, throws if no digits follow it
+size_t digits_begin(const std::string& str) {
+  size_t begin = str.starts_with("+") || str.starts_with("-") ? 1 : 0;
+  if (begin == str.size()) {
+    throw std::invalid_argument("number expected at position " + std::to_string(begin));
+  }
+  return begin;
+}
+
+// bits [64 * i, 64 * i + 64) of a[0, n)
+uint64_t chunk64(const digit* a, size_t n, size_t i) {
+  if constexpr (DIGIT_LEN == 64) {
+    return i < n ? a[i] : 0;
+  } else {
+    uint64_t low = 2 * i < n ? a[2 * i] : 0;
+    uint64_t high = 2 * i + 1 < n ? a[2 * i + 1] : 0;
+    return low | high << 32;
+  }
+}
+
+void set_chunk64(digit* a, size_t i, uint64_t x) {
+  if constexpr (DIGIT_LEN == 64) {
+    a[i] = x;
+  } else {
+    a[2 * i] = static_cast<digit>(x);
+    a[2 * i + 1] = static_cast<digit>(x >> 32);
+  }
+}
+
+// the two characters of each byte
+constexpr std::array<std::array<char, 2>, 256> HEX_PAIRS = [] {
+  std::array<std::array<char, 2>, 256> pairs{};
+  for (size_t i = 0; i < 256; ++i) {
+    pairs[i] = {RADIX_DIGITS[i >> 4], RADIX_DIGITS[i & 15]};
+  }
+  return pairs;
+}();
+
+// the 16 hex characters of x
+void write_hex16_generic(char* out, uint64_t x) {
+  for (size_t i = 8; i-- > 0; x >>= 8) {
+    std::memcpy(out + 2 * i, HEX_PAIRS[x & 0xFF].data(), 2);
+  }
+}
+
+// the value of 16 hex characters, false if any of them is not one
+bool read_hex16_generic(const char* in, uint64_t& x) {
+  x = 0;
+  uint8_t all = 0;
+  for (size_t i = 0; i < 16; ++i) {
+    uint8_t v = RADIX_VALUES[static_cast<unsigned char>(in[i])];
+    all |= v;
+    x = x << 4 | (v & 15);
+  }
+  return all < 16;
+}
+
+#ifdef BIGINT_X86_64_DISPATCH
+// The same with SSSE3: the nibbles of the bytes in the order of the characters are looked up in a 16-entry
+// table by a byte shuffle, the characters are validated and converted back by range checks and paired into
+// bytes by a multiply-add.
+[[gnu::target("ssse3")]] void write_hex16_ssse3(char* out, uint64_t x) {
+  __m128i bytes = _mm_cvtsi64_si128(static_cast<long long>(__builtin_bswap64(x)));
+  __m128i low_mask = _mm_set1_epi8(0x0F);
+  __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask), _mm_and_si128(bytes, low_mask));
+  __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(RADIX_DIGITS));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(table, nibbles));
+}
+
+[[gnu::target("ssse3")]] bool read_hex16_ssse3(const char* in, uint64_t& x) {
+  __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  // c - '0' < 10 and (c | 0x20) - 'a' < 6 as unsigned bytes, by signed comparisons shifted by 0x80
+  __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+  __m128i dec = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i is_dec = _mm_cmplt_epi8(_mm_xor_si128(dec, bias), _mm_set1_epi8(static_cast<char>(0x80 + 10)));
+  __m128i hex = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_hex = _mm_cmplt_epi8(_mm_xor_si128(hex, bias), _mm_set1_epi8(static_cast<char>(0x80 + 6)));
+  if (_mm_movemask_epi8(_mm_or_si128(is_dec, is_hex)) != 0xFFFF) {
+    return false;
+  }
+  __m128i values = _mm_or_si128(_mm_and_si128(is_dec, dec),
+                                _mm_and_si128(is_hex, _mm_add_epi8(hex, _mm_set1_epi8(10))));
+  __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(values, _mm_set1_epi16(0x0110)), _mm_setzero_si128());
+  x = __builtin_bswap64(static_cast<uint64_t>(_mm_cvtsi128_si64(bytes)));
+  return true;
+}
+#endif
+
+using write_hex16_fn = void (*)(char* out, uint64_t x);
+using read_hex16_fn = bool (*)(const char* in, uint64_t& x);
+
+write_hex16_fn select_write_hex16() {
+#ifdef BIGINT_X86_64_DISPATCH
+  if (cpu().ssse3) {
+    return write_hex16_ssse3;
+  }
+#endif
+  return write_hex16_generic;
+}
+
+read_hex16_fn select_read_hex16() {
+#ifdef BIGINT_X86_64_DISPATCH
+  if (cpu().ssse3) {
+    return read_hex16_ssse3;
+  }
+#endif
+  return read_hex16_generic;
+}
+
+// the value of the digits of base 2^k in str[begin, str.size()), throws for other characters
+void parse_radix(digit_vector& r, const std::string& str, size_t begin, size_t k) {
+  size_t len = str.size() - begin;
+  r.clear();
+  r.resize(len * k / DIGIT_LEN + 2);
+  size_t pos = 0;
+  size_t end = str.size();
+  if (k == 4) {
+    read_hex16_fn read_hex16 = select_read_hex16();
+    // whole 64-bit chunks from the lowest one
+    for (; end - begin >= 16; end -= 16, pos += 64) {
+      uint64_t x;
+      if (!read_hex16(str.data() + end - 16, x)) {
+        break;
+      }
+      set_chunk64(r.data(), pos / 64, x);
+    }
+  }
+  digit base = digit(1) << k;
+  for (size_t i = end; i-- > begin; pos += k) {
+    digit v = RADIX_VALUES[static_cast<unsigned char>(str[i])];
+    if (v >= base) {
+      bad_symbol(str, i);
+    }
+    r[pos / DIGIT_LEN] |= v << pos % DIGIT_LEN;
+    if (pos % DIGIT_LEN + k > DIGIT_LEN) {
+      r[pos / DIGIT_LEN + 1] |= v >> (DIGIT_LEN - pos % DIGIT_LEN);
+    }
+  }
+  strip(r);
+}
+
+// the digits of base 2^k of a > 0 with a minus sign if negative
+std::string format_radix(const digit_vector& a, size_t k, bool negative) {
+  size_t bits = a.size() * DIGIT_LEN - std::countl_zero(a.back());
+  size_t len = (bits + k - 1) / k;
+  std::string s(negative + len, '-');
+  char* out = s.data() + negative;
+  size_t j = 0;
+  if (k == 4) {
+    write_hex16_fn write_hex16 = select_write_hex16();
+    for (; len - j >= 16; j += 16) {
+      write_hex16(out + len - j - 16, chunk64(a.data(), a.size(), j / 16));
+    }
+  }
+  // j * k is a multiple of 64 here
+  size_t i = j * k / DIGIT_LEN;
+  double_digit acc = 0;
+  size_t acc_bits = 0;
+  for (; j < len; ++j) {
+    if (acc_bits < k) {
+      acc |= static_cast<double_digit>(i < a.size() ? a[i] : 0) << acc_bits;
+      ++i;
+      acc_bits += DIGIT_LEN;
+    }
+    out[len - 1 - j] = RADIX_DIGITS[acc & ((1 << k) - 1)];
+    acc >>= k;
+    acc_bits -= k;
+  }
+  return s;
+}
+} // namespace
+
+big_integer::big_integer(const std::string& str) {
+  BIGINT_PROBE(FROM_STRING, str.size(), 0);
+  bool _sign = str.starts_with("-");
+  size_t begin = digits_begin(str);
+  for (size_t i = begin; i < str.size(); ++i) {
+    if (str[i] < '0' || str[i] > '9') {
+      bad_symbol(str, i);
+    }
+  }
+  size_t len = str.size() - begin;
+  std::vector<digit_vector> powers;
+  if (len > FROM_STRING_THRESHOLD * DEC_DIGIT_LEN) {
+    extend_dec_powers(powers);
+    while ((DEC_DIGIT_LEN << powers.size()) < len) {
+      extend_dec_powers(powers);
+    }
+  }
+  data = parse_decimal(str.data() + begin, len, std::max<size_t>(powers.size(), 1) - 1, powers);
+  sign = _sign;
+}
+
+std::string to_string(big_integer a) {
+  BIGINT_PROBE(TO_STRING, a.data.size(), 0);
+  if (a.is_zero()) {
+    return "0";
+  }
+  std::vector<digit_vector> powers;
+  if (a.data.size() >= TO_STRING_THRESHOLD) {
+    extend_dec_powers(powers);
+    while (2 * powers.back().size() - 1 <= a.data.size()) {
+      extend_dec_powers(powers);
+    }
+  }
+  // upper bound of the decimal length rounded up to whole DEC_BASE digits, log10(2) < 0.30103
+  size_t bits = a.data.size() * DIGIT_LEN - std::countl_zero(a.data.back());
+  size_t width = (bits * 30103 / 100000 + DEC_DIGIT_LEN) / DEC_DIGIT_LEN * DEC_DIGIT_LEN;
+  size_t sign_len = a.is_negative() ? 1 : 0;
+  std::string s(sign_len + width, '-');
+  write_decimal(s.data() + sign_len, width, a.data, std::max<size_t>(powers.size(), 1) - 1, powers);
+  s.erase(sign_len, s.find_first_not_of('0', sign_len) - sign_len);
+  return s;
+}
+
+big_integer::big_integer(const std::string& str, int base) {
+  BIGINT_PROBE(FROM_STRING, str.size(), 0);
+  if (base == 10) {
+    *this = big_integer(str);
+    return;
+  }
+  size_t k = radix_bits(base);
+  if (k == 0) {
+    throw std::invalid_argument("unsupported base " + std::to_string(base));
+  }
+  parse_radix(data, str, digits_begin(str), k);
+  sign = str.starts_with("-");
+}
+
+std::string to_string(const big_integer& a, int base) {
+  BIGINT_PROBE(TO_STRING, a.data.size(), 0);
+  if (base == 10) {
+    return to_string(a);
+  }
+  size_t k = radix_bits(base);
+  if (k == 0) {
+    throw std::invalid_argument("unsupported base " + std::to_string(base));
+  }
+  if (a.is_zero()) {
+    return "0";
+  }
+  return format_radix(a.data, k, a.is_negative());
+}
+
+bool big_integer::is_zero() const {
+  return data.empty();
+}
+
+bool big_integer::is_positive() const {
+  return !is_zero() && !sign;
+}
+
+bool big_integer::is_negative() const {
+  return !is_zero() && sign;
+}
+
+void big_integer::shrink() {
+#ifdef BIGINT_INSTRUMENTATION
+  shrink_count += !data.empty() && !data.back();
+#endif
+  while (!data.empty() && !data.back()) {
+    data.pop_back();
+  }
+}
+
+void swap(big_integer& a, big_integer& b) {
+  std::swap(a.data, b.data);
+  std::swap(a.sign, b.sign);
+}
+
+big_integer& big_integer::negate() {
+  sign = !sign;
+  return *this;
+}
+
+big_integer& big_integer::resize(size_t len) {
+  data.resize(len, 0);
+  return *this;
+}
+
+big_integer& big_integer::true_negate(size_t len) {
+  resize(len);
+  for (auto& v : data) {
+    v = ~v;
+  }
+  add_digit(1);
+  return *this;
+}
+
+std::ostream& operator<<(std::ostream& out, const big_integer& a) {
+  return out << to_string(a);
+}
+
+namespace {
+// The record header: the magic "BI", the format version, the flags with the sign in bit 0 and the number
+// of limbs as a 32-bit little-endian value. The limbs that follow have no leading zero one.
+const size_t RECORD_HEADER_SIZE = 8;
+const size_t RECORD_LIMB_SIZE = 8;
+const size_t DIGITS_PER_LIMB = RECORD_LIMB_SIZE / sizeof(digit);
+const unsigned char RECORD_VERSION = 1;
+// streams are read by this many limbs at first, so that a corrupt length fails on the missing bytes rather
+// than on a huge allocation
+const size_t RECORD_READ_CHUNK = 1 << 16;
+static_assert(std::endian::native == std::endian::little, "records keep the digits as they are in memory");
+
+struct record_header {
+  bool sign;
+  size_t limbs;
+};
+
+void write_header(unsigned char* out, bool sign, size_t limbs) {
+  assert(limbs <= UINT32_MAX);
+  out[0] = 'B';
+  out[1] = 'I';
+  out[2] = RECORD_VERSION;
+  out[3] = sign;
+  for (size_t i = 0; i < 4; ++i) {
+    out[4 + i] = static_cast<unsigned char>(limbs >> (8 * i));
+  }
+}
+
+record_header read_header(const unsigned char* in) {
+  if (in[0] != 'B' || in[1] != 'I') {
+    throw std::invalid_argument("big_integer record expected");
+  }
+  if (in[2] != RECORD_VERSION) {
+    throw std::invalid_argument("unsupported big_integer record version " + std::to_string(in[2]));
+  }
+  if (in[3] > 1) {
+    throw std::invalid_argument("unknown big_integer record flags " + std::to_string(in[3]));
+  }
+  size_t limbs = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    limbs |= static_cast<size_t>(in[4 + i]) << (8 * i);
+  }
+  return {in[3] == 1, limbs};
+}
+
+} // namespace
+
+void big_integer::write_to(std::ostream& out) const {
+  size_t limbs = (data.size() + DIGITS_PER_LIMB - 1) / DIGITS_PER_LIMB;
+  unsigned char header[RECORD_HEADER_SIZE];
+  write_header(header, is_negative(), limbs);
+  out.write(reinterpret_cast<const char*>(header), RECORD_HEADER_SIZE);
+  out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(digit));
+  // the top limb is completed by zero digits
+  const char padding[RECORD_LIMB_SIZE] = {};
+  out.write(padding, limbs * RECORD_LIMB_SIZE - data.size() * sizeof(digit));
+}
+
+void big_integer::read_from(std::istream& in) {
+  data.clear();
+  sign = false;
+  unsigned char header[RECORD_HEADER_SIZE];
+  if (!in.read(reinterpret_cast<char*>(header), RECORD_HEADER_SIZE)) {
+    throw std::invalid_argument("truncated big_integer record");
+  }
+  record_header h = read_header(header);
+  // the chunks double with the bytes already read, the buffer outgrows the stream at most twice
+  size_t limbs = 0;
+  while (limbs != h.limbs) {
+    size_t chunk = std::min(h.limbs - limbs, std::max(RECORD_READ_CHUNK, limbs));
+    data.resize((limbs + chunk) * DIGITS_PER_LIMB);
+    if (!in.read(reinterpret_cast<char*>(data.data() + limbs * DIGITS_PER_LIMB), chunk * RECORD_LIMB_SIZE)) {
+      data.clear();
+      throw std::invalid_argument("truncated big_integer record");
+    }
+    limbs += chunk;
+  }
+  shrink();
+  if (h.limbs != 0 && data.size() <= (h.limbs - 1) * DIGITS_PER_LIMB) {
+    data.clear();
+    throw std::invalid_argument("leading zero limb in big_integer record");
+  }
+  sign = h.sign;
+}
+
+big_integer_view::big_integer_view(const void* data, size_t size) {
+  auto bytes = static_cast<const unsigned char*>(data);
+  if (size < RECORD_HEADER_SIZE) {
+    throw std::invalid_argument("truncated big_integer record");
+  }
+  record_header h = read_header(bytes);
+  if ((size - RECORD_HEADER_SIZE) / RECORD_LIMB_SIZE < h.limbs) {
+    throw std::invalid_argument("truncated big_integer record");
+  }
+  _digits = reinterpret_cast<const digit*>(bytes + RECORD_HEADER_SIZE);
+  assert(reinterpret_cast<uintptr_t>(_digits) % alignof(digit) == 0);
+  _size = h.limbs * DIGITS_PER_LIMB;
+  while (_size != 0 && _digits[_size - 1] == 0) {
+    --_size;
+  }
+  if (h.limbs != 0 && _size <= (h.limbs - 1) * DIGITS_PER_LIMB) {
+    throw std::invalid_argument("leading zero limb in big_integer record");
+  }
+  _record_size = RECORD_HEADER_SIZE + h.limbs * RECORD_LIMB_SIZE;
+  _sign = h.sign && _size != 0;
+}
+
+bool big_integer_view::is_negative() const noexcept {
+  return _sign;
+}
+
+const big_integer::digit* big_integer_view::digits() const noexcept {
+  return _digits;
+}
+
+size_t big_integer_view::size() const noexcept {
+  return _size;
+}
+
+size_t big_integer_view::record_size() const noexcept {
+  return _record_size;
+}
+
+big_integer_view::operator big_integer() const {
+  big_integer res;
+  res.data.assign(_digits, _digits + _size);
+  res.sign = _sign;
+  return res;
+}
+
+bool big_integer_view::operator==(const big_integer& other) const noexcept {
+  return _size == other.data.size() && _sign == other.is_negative() &&
+         std::equal(_digits, _digits + _size, other.data.begin());
+}
+
+big_integer_memory_scope::big_integer_memory_scope(std::pmr::memory_resource* resource) noexcept
+    : _previous(std::exchange(small_vector_resource, resource)) {}
+
+big_integer_memory_scope::~big_integer_memory_scope() {
+  small_vector_resource = _previous;
+}
+
+big_integer_parallel_scope::big_integer_parallel_scope(thread_pool* pool) noexcept
+    : _previous(std::exchange(parallel_pool, pool)) {}
+
+big_integer_parallel_scope::~big_integer_parallel_scope() {
+  parallel_pool = _previous;
 }
@@ -1,22 +1,40 @@
 #pragma once
 
+#include "small_vector.h"
+
+#include <array>
 #include <cstdint>
 #include <iosfwd>
 #include <string>
-#include <vector>
+#include <tuple>
+#include <utility>
+
+class big_integer_product;
+class divisor;
+class thread_pool;
+
+template <size_t Bits>
+class fixed_big_integer;
 
 struct big_integer {
 public:
+#ifdef BIGINT_64BIT_DIGITS
+  using digit = uint64_t;
+#else
   using digit = uint32_t;
+#endif
+  // numbers up to 128 bits are kept inline without a heap allocation
+  using digit_vector = small_vector<digit, 128 / (8 * sizeof(digit))>;
 
 private:
-  std::vector<digit> data;
+  digit_vector data;
   bool sign = false; // sign == (this < 0)
                      //-0 is possible and equals to +0
 
 public:
   big_integer() noexcept;
   big_integer(const big_integer& other);
+  big_integer(big_integer&& other) noexcept;
 
   template <class T>
   requires std::is_integral_v<T>
@@ -24,15 +42,24 @@ public:
 
   big_integer(unsigned long long a, bool sign = false);
   explicit big_integer(const std::string& str);
+  // digits of base 10 or of a power of two base up to 32, letters in either case
+  explicit big_integer(const std::string& str, int base);
   ~big_integer();
 
   big_integer& operator=(const big_integer& other);
+  big_integer& operator=(big_integer&& other);
 
   big_integer& operator+=(const big_integer& rhs);
   big_integer& operator-=(const big_integer& rhs);
   big_integer& operator*=(const big_integer& rhs);
+  // accumulate b * c in place without building it as a separate number
+  big_integer& operator+=(const big_integer_product& rhs);
+  big_integer& operator-=(const big_integer_product& rhs);
   big_integer& operator/=(const big_integer& rhs);
   big_integer& operator%=(const big_integer& rhs);
+  // rounded like the division by a number, the reciprocal of the divisor replaces the hardware division
+  big_integer& operator/=(const divisor& rhs);
+  big_integer& operator%=(const divisor& rhs);
 
   big_integer& operator&=(const big_integer& rhs);
   big_integer& operator|=(const big_integer& rhs);
@@ -42,8 +69,10 @@ public:
   big_integer& operator>>=(int rhs);
 
   big_integer operator+() const;
-  big_integer operator-() const;
-  big_integer operator~() const;
+  big_integer operator-() const&;
+  big_integer operator-() &&;
+  big_integer operator~() const&;
+  big_integer operator~() &&;
 
   big_integer& operator++();
   big_integer operator++(int);
@@ -59,12 +88,35 @@ public:
   friend bool operator>=(const big_integer& a, const big_integer& b);
 
   friend std::string to_string(big_integer a);
+  // base 10 or a power of two base up to 32 in lowercase letters, the latter are sliced from the bits directly
+  friend std::string to_string(const big_integer& a, int base);
+
+  // Binary record: an 8-byte header with the sign and the length, then |this| in 64-bit little-endian limbs
+  // from the lowest one, the same for both digit sizes. read_from replaces the number, reusing its buffer,
+  // and throws std::invalid_argument for a malformed or truncated record.
+  void write_to(std::ostream& out) const;
+  void read_from(std::istream& in);
 
 private:
+  friend class big_integer_product;
+  friend class big_integer_view;
+  template <size_t Bits>
+  friend class fixed_big_integer;
+  friend class montgomery_context;
+  friend big_integer& addmul(big_integer& acc, const big_integer& b, const big_integer& c);
+  friend big_integer& submul(big_integer& acc, const big_integer& b, const big_integer& c);
+  friend big_integer& mul_add_digit(big_integer& acc, const big_integer& b, big_integer::digit d);
+  friend big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
+  friend big_integer gcd(const big_integer& a, const big_integer& b);
+  friend std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b);
+  friend big_integer mod_inverse(const big_integer& a, const big_integer& mod);
+  friend big_integer isqrt(const big_integer& a);
+  friend big_integer iroot(const big_integer& a, unsigned k);
+  friend big_integer factorial(digit n);
+  friend big_integer binomial(digit n, digit k);
+  friend big_integer primorial(digit n);
   friend void swap(big_integer& a, big_integer& b);
   friend bool unsigned_less(const big_integer& a, const big_integer& b);
-  friend big_integer::digit trial(const big_integer& r, const big_integer& d, size_t k, size_t m);
-  friend std::pair<big_integer, big_integer> unsigned_div(const big_integer& x, const big_integer& y, size_t m);
   friend std::pair<big_integer, big_integer> div(const big_integer& x, const big_integer& y);
   void shrink();
   big_integer& negate();
@@ -78,6 +130,8 @@ private:
   void subtract_digit(digit rhs);
   void difference(const big_integer& rhs, size_t k, size_t m);
   void multiply_digit(digit rhs);
+  // adds |b| * c[0, cn) with the sign of b flipped if negative, neither may refer to this number
+  void add_product(const big_integer& b, const digit* c, size_t cn, bool negative);
   big_integer& resize(size_t len);
   template <class BinaryOperation>
   big_integer& binary(const big_integer& rhs, const BinaryOperation& op);
@@ -89,18 +143,116 @@ private:
   digit div_digit(digit rhs);
 };
 
+// b * c is not computed until it is converted to big_integer, so that a += b * c and a = b * c + d
+// accumulate the product right in the result. Factors given as temporaries are moved into it, the others
+// are referred to, so the product may be kept in an auto variable as long as the named factors live.
+class big_integer_product {
+public:
+  big_integer_product(const big_integer& lhs, const big_integer& rhs) noexcept : _lhs(&lhs), _rhs(&rhs) {}
+  big_integer_product(big_integer&& lhs, const big_integer& rhs) noexcept : _lhs_value(std::move(lhs)), _rhs(&rhs) {}
+  big_integer_product(const big_integer& lhs, big_integer&& rhs) noexcept : _rhs_value(std::move(rhs)), _lhs(&lhs) {}
+  big_integer_product(big_integer&& lhs, big_integer&& rhs) noexcept
+      : _lhs_value(std::move(lhs)), _rhs_value(std::move(rhs)) {}
+
+  operator big_integer() const;
+
+  const big_integer& lhs() const noexcept {
+    return _lhs ? *_lhs : _lhs_value;
+  }
+
+  const big_integer& rhs() const noexcept {
+    return _rhs ? *_rhs : _rhs_value;
+  }
+
+private:
+  big_integer _lhs_value;
+  big_integer _rhs_value;
+  // the factors referred to, nullptr for the ones held by value
+  const big_integer* _lhs = nullptr;
+  const big_integer* _rhs = nullptr;
+};
+
+// A number stored by write_to in a buffer, such as a memory-mapped file, used in place without parsing or
+// copying. The buffer must outlive the view and be aligned for digits; records written one after another
+// from an aligned start are, since all of them are multiples of 8 bytes long.
+class big_integer_view {
+public:
+  // checks the record at data with size bytes available and throws std::invalid_argument if it is not valid
+  big_integer_view(const void* data, size_t size);
+
+  bool is_negative() const noexcept;
+  // the digits of the absolute value from the lowest one, without leading zeros
+  const big_integer::digit* digits() const noexcept;
+  size_t size() const noexcept;
+  // the number of bytes the record takes, the next one starts right after it
+  size_t record_size() const noexcept;
+
+  explicit operator big_integer() const;
+
+  bool operator==(const big_integer& other) const noexcept;
+
+private:
+  const big_integer::digit* _digits;
+  size_t _size;
+  size_t _record_size;
+  bool _sign;
+};
+
+// overloads taking an rvalue reuse its digits for the result, products and quotients are always
+// built in a new buffer
 big_integer operator+(const big_integer& a, const big_integer& b);
+big_integer operator+(big_integer&& a, const big_integer& b);
+big_integer operator+(const big_integer& a, big_integer&& b);
+big_integer operator+(big_integer&& a, big_integer&& b);
 big_integer operator-(const big_integer& a, const big_integer& b);
-big_integer operator*(const big_integer& a, const big_integer& b);
+big_integer operator-(big_integer&& a, const big_integer& b);
+big_integer operator-(const big_integer& a, big_integer&& b);
+big_integer operator-(big_integer&& a, big_integer&& b);
+big_integer_product operator*(const big_integer& a, const big_integer& b) noexcept;
+big_integer_product operator*(big_integer&& a, const big_integer& b) noexcept;
+big_integer_product operator*(const big_integer& a, big_integer&& b) noexcept;
+big_integer_product operator*(big_integer&& a, big_integer&& b) noexcept;
 big_integer operator/(const big_integer& a, const big_integer& b);
 big_integer operator%(const big_integer& a, const big_integer& b);
 
 big_integer operator&(const big_integer& a, const big_integer& b);
+big_integer operator&(big_integer&& a, const big_integer& b);
+big_integer operator&(const big_integer& a, big_integer&& b);
+big_integer operator&(big_integer&& a, big_integer&& b);
 big_integer operator|(const big_integer& a, const big_integer& b);
+big_integer operator|(big_integer&& a, const big_integer& b);
+big_integer operator|(const big_integer& a, big_integer&& b);
+big_integer operator|(big_integer&& a, big_integer&& b);
 big_integer operator^(const big_integer& a, const big_integer& b);
+big_integer operator^(big_integer&& a, const big_integer& b);
+big_integer operator^(const big_integer& a, big_integer&& b);
+big_integer operator^(big_integer&& a, big_integer&& b);
 
 big_integer operator<<(const big_integer& a, int b);
+big_integer operator<<(big_integer&& a, int b);
 big_integer operator>>(const big_integer& a, int b);
+big_integer operator>>(big_integer&& a, int b);
+
+// the product is added to or subtracted from the other operand in place
+big_integer operator+(const big_integer_product& a, const big_integer& b);
+big_integer operator+(const big_integer_product& a, big_integer&& b);
+big_integer operator+(const big_integer& a, const big_integer_product& b);
+big_integer operator+(big_integer&& a, const big_integer_product& b);
+big_integer operator+(const big_integer_product& a, const big_integer_product& b);
+big_integer operator-(const big_integer_product& a, const big_integer& b);
+big_integer operator-(const big_integer_product& a, big_integer&& b);
+big_integer operator-(const big_integer& a, const big_integer_product& b);
+big_integer operator-(big_integer&& a, const big_integer_product& b);
+big_integer operator-(const big_integer_product& a, const big_integer_product& b);
+big_integer operator+(const big_integer_product& a);
+big_integer operator-(const big_integer_product& a);
+big_integer operator~(const big_integer_product& a);
+
+// acc += b * c and acc -= b * c, the product is added row by row for short factors
+big_integer& addmul(big_integer& acc, const big_integer& b, const big_integer& c);
+big_integer& submul(big_integer& acc, const big_integer& b, const big_integer& c);
+// acc += b * d for a single digit d
+big_integer& mul_add_digit(big_integer& acc, const big_integer& b, big_integer::digit d);
 
 bool operator==(const big_integer& a, const big_integer& b);
 bool operator!=(const big_integer& a, const big_integer& b);
@@ -110,6 +262,155 @@ bool operator<=(const big_integer& a, const big_integer& b);
 bool operator>=(const big_integer& a, const big_integer& b);
 
 std::string to_string(big_integer a);
+std::string to_string(const big_integer& a, int base);
 std::ostream& operator<<(std::ostream& out, const big_integer& a);
 
 void swap(big_integer& a, big_integer& b);
+
+// A nonzero digit with its reciprocal precomputed as by Möller and Granlund, division by it takes two
+// multiplications per digit instead of a hardware division. Worth keeping for repeated division by the
+// same value, e.g. a small modulus.
+class divisor {
+public:
+  explicit divisor(big_integer::digit d);
+
+  big_integer::digit value() const noexcept;
+
+private:
+  friend struct big_integer;
+
+  big_integer::digit _value;
+  big_integer::digit _inverse; // of the value shifted up to the highest bit
+  unsigned _shift;
+};
+
+big_integer operator/(big_integer a, const divisor& d);
+big_integer operator%(big_integer a, const divisor& d);
+
+// Arithmetic modulo an odd m in Montgomery form x * R mod m, R = BASE^n for n digits of m.
+// Numbers in the form multiply with a single reduction and no division.
+class montgomery_context {
+public:
+  explicit montgomery_context(const big_integer& mod);
+
+  const big_integer& mod() const;
+
+  // a is reduced modulo m first, the result is in [0, m)
+  big_integer to_form(const big_integer& a) const;
+  big_integer from_form(const big_integer& a) const;
+  // a * b / R mod m for a, b in [0, m)
+  big_integer mul(const big_integer& a, const big_integer& b) const;
+  // base^exp mod m for exp >= 0, neither the arguments nor the result are in the form
+  big_integer pow(const big_integer& base, const big_integer& exp) const;
+
+private:
+  big_integer _mod;
+  big_integer _r2; // R^2 mod m
+  big_integer::digit _inv; // -m^(-1) mod BASE
+};
+
+// base^exp mod |mod| in [0, |mod|) for exp >= 0 and mod != 0, odd moduli use montgomery_context
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
+
+// gcd(|a|, |b|) by Lehmer's algorithm on the top two digits, long pairs are first shortened by the half gcd
+// of their top digits. gcd(0, 0) = 0
+big_integer gcd(const big_integer& a, const big_integer& b);
+// (g, x, y) with a * x + b * y = g = gcd(a, b)
+std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b);
+// the inverse of a modulo |mod| in [0, |mod|) for mod != 0, or 0 if a and mod are not coprime
+big_integer mod_inverse(const big_integer& a, const big_integer& mod);
+// floor(sqrt(a)) for a >= 0, the top half of the root comes from the root of the top half of a
+big_integer isqrt(const big_integer& a);
+// the k-th root of a rounded towards zero for k > 0 and a >= 0 if k is even, by Newton's iteration that starts
+// from the root of the top half of a
+big_integer iroot(const big_integer& a, unsigned k);
+// n! as (n / 2)!^2 times the swing n! / ((n / 2)!)^2, which is multiplied out from its prime factorization
+// by a balanced product tree. With a parallel scope the independent subtrees are tasks of the pool.
+big_integer factorial(big_integer::digit n);
+// n! / (k! * (n - k)!), 0 for k > n, from the exponents of its prime factors
+big_integer binomial(big_integer::digit n, big_integer::digit k);
+// the product of the primes up to n
+big_integer primorial(big_integer::digit n);
+
+// While alive, numbers constructed on this thread and the temporary buffers of arithmetic take their heap
+// digits from the given resource, so a batch of short-lived numbers can live on a monotonic_buffer_resource
+// and be released at once. A number keeps the resource it was constructed with: numbers from before the scope
+// stay off it even when they grow or are assigned inside it, the ones constructed inside may leave the scope
+// but must not outlive its resource. Scopes nest, nullptr restores operator new.
+class big_integer_memory_scope {
+public:
+  explicit big_integer_memory_scope(std::pmr::memory_resource* resource) noexcept;
+
+  big_integer_memory_scope(const big_integer_memory_scope&) = delete;
+  big_integer_memory_scope& operator=(const big_integer_memory_scope&) = delete;
+
+  ~big_integer_memory_scope();
+
+private:
+  std::pmr::memory_resource* _previous;
+};
+
+// While alive, long multiplications and decimal conversions on this thread split their independent
+// sub-products and halves into tasks of the pool. The tasks use the memory resource of the thread that
+// spawned them, so together with big_integer_memory_scope it has to be a synchronized one.
+// Scopes nest, nullptr turns splitting off.
+class big_integer_parallel_scope {
+public:
+  explicit big_integer_parallel_scope(thread_pool* pool) noexcept;
+
+  big_integer_parallel_scope(const big_integer_parallel_scope&) = delete;
+  big_integer_parallel_scope& operator=(const big_integer_parallel_scope&) = delete;
+
+  ~big_integer_parallel_scope();
+
+private:
+  thread_pool* _previous;
+};
+
+#ifdef BIGINT_INSTRUMENTATION
+// Counters that builds with BIGINT_INSTRUMENTATION keep for the entry points of big_integer, summed over
+// all threads. A call made from inside another entry point on the same thread belongs to the outer one.
+struct big_integer_statistics {
+  enum operation : size_t {
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    AND,
+    OR,
+    XOR,
+    SHL,
+    SHR,
+    GCD,
+    POW_MOD,
+    TO_STRING,
+    FROM_STRING,
+    COUNT
+  };
+
+  static constexpr std::array<const char*, COUNT> NAMES{
+      "add", "sub", "mul", "div", "mod", "and", "or", "xor", "shl", "shr", "gcd", "pow_mod", "to_string",
+      "from_string"};
+
+  // bucket i of a size histogram counts the sizes of bit length i: bucket 0 is zero, bucket i > 0 is
+  // [2^(i - 1), 2^i). Sizes are in digits, of strings in characters, of shifts in whole digits.
+  static constexpr size_t SIZE_BUCKETS = 48;
+
+  struct counters {
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    // heap buffers taken by digit vectors during the calls, temporaries included
+    uint64_t allocations = 0;
+    // normalizations that dropped leading zero digits
+    uint64_t shrinks = 0;
+    std::array<uint64_t, SIZE_BUCKETS> lhs_sizes{};
+    std::array<uint64_t, SIZE_BUCKETS> rhs_sizes{};
+  };
+
+  std::array<counters, COUNT> operations{};
+};
+
+big_integer_statistics big_integer_statistics_snapshot();
+void reset_big_integer_statistics();
+#endif
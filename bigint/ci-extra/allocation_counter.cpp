@@ -0,0 +1,76 @@
+// Replaces the global allocation functions to count heap allocations made by every test
+// from tests.cpp, linked into the allocation-benchmark target instead of the usual test binary.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// the tests of the thread pool allocate on its workers too
+std::atomic<size_t> allocations = 0;
+std::atomic<size_t> allocated_bytes = 0;
+
+class allocation_listener : public ::testing::EmptyTestEventListener {
+public:
+  void OnTestStart(const ::testing::TestInfo& /*info*/) override {
+    start_allocations = allocations.load(std::memory_order_relaxed);
+    start_bytes = allocated_bytes.load(std::memory_order_relaxed);
+  }
+
+  void OnTestEnd(const ::testing::TestInfo& info) override {
+    size_t count = allocations.load(std::memory_order_relaxed) - start_allocations;
+    size_t bytes = allocated_bytes.load(std::memory_order_relaxed) - start_bytes;
+    total_allocations += count;
+    total_bytes += bytes;
+    std::printf("[ ALLOCS   ] %s.%s: %zu allocations, %zu bytes\n", info.test_suite_name(), info.name(), count, bytes);
+  }
+
+  void OnTestProgramEnd(const ::testing::UnitTest& /*unit_test*/) override {
+    std::printf("[ ALLOCS   ] total: %zu allocations, %zu bytes\n", total_allocations, total_bytes);
+  }
+
+private:
+  size_t start_allocations = 0;
+  size_t start_bytes = 0;
+  size_t total_allocations = 0;
+  size_t total_bytes = 0;
+};
+
+const bool listener_registered = [] {
+  ::testing::UnitTest::GetInstance()->listeners().Append(new allocation_listener());
+  return true;
+}();
+} // namespace
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+  std::free(ptr);
+}
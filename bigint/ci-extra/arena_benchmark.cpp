@@ -0,0 +1,97 @@
+// Times the multiply-then-divide workload of correctness_random.mul_div_randomized with the digits
+// on the global heap and on memory resources that are released after every round.
+
+#include "../big_integer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+namespace {
+// every configuration runs about this many multiplications in total
+constexpr size_t NUMBER_OF_MULTIPLICATIONS = 1000000;
+
+int64_t shifted_rand() {
+  int64_t val = rand() - RAND_MAX / 2;
+  if (val != 0) {
+    return val;
+  } else {
+    return 1;
+  }
+}
+
+struct round_data {
+  std::vector<int64_t> multipliers;
+  std::vector<int64_t> divisors;
+};
+
+std::vector<round_data> make_rounds(size_t multipliers_per_round) {
+  std::mt19937 rng(322);
+  std::vector<round_data> rounds(NUMBER_OF_MULTIPLICATIONS / multipliers_per_round);
+  for (auto& round : rounds) {
+    for (size_t i = 0; i != multipliers_per_round; ++i) {
+      round.multipliers.push_back(shifted_rand());
+    }
+    round.divisors = round.multipliers;
+    std::shuffle(round.divisors.begin(), round.divisors.end(), rng);
+  }
+  return rounds;
+}
+
+// multiplies by every multiplier and divides by all divisors but the first one, returns whether
+// the first divisor is left
+bool run_round(const round_data& round) {
+  big_integer accumulator = 1;
+  for (int64_t m : round.multipliers) {
+    accumulator *= m;
+  }
+  for (size_t i = 1; i != round.divisors.size(); ++i) {
+    accumulator /= round.divisors[i];
+  }
+  return accumulator == round.divisors[0];
+}
+
+template <typename Round>
+void measure(const char* name, const std::vector<round_data>& rounds, Round&& round) {
+  size_t failures = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& data : rounds) {
+    failures += !round(data);
+  }
+  auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+  std::printf("  %-28s %9.3f us/round%s\n", name, elapsed.count() / rounds.size(), failures ? "  WRONG RESULT" : "");
+}
+} // namespace
+
+int main() {
+  for (size_t multipliers_per_round : {10, 30, 100, 300}) {
+    std::vector<round_data> rounds = make_rounds(multipliers_per_round);
+    std::printf("%zu multipliers per round:\n", multipliers_per_round);
+
+    measure("operator new", rounds, run_round);
+
+    measure("monotonic_buffer_resource", rounds, [](const round_data& data) {
+      std::pmr::monotonic_buffer_resource arena;
+      big_integer_memory_scope scope(&arena);
+      return run_round(data);
+    });
+
+    std::vector<std::byte> storage(1 << 20);
+    measure("monotonic, reused storage", rounds, [&storage](const round_data& data) {
+      std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size());
+      big_integer_memory_scope scope(&arena);
+      return run_round(data);
+    });
+
+    std::pmr::unsynchronized_pool_resource pool;
+    measure("unsynchronized_pool_resource", rounds, [&pool](const round_data& data) {
+      big_integer_memory_scope scope(&pool);
+      return run_round(data);
+    });
+  }
+}
@@ -17,8 +17,10 @@ big_integer_gmp::big_integer_gmp(int a) {
   mpz_init_set_si(mpz, a);
 }
 
-big_integer_gmp::big_integer_gmp(const std::string& str) {
-  if (mpz_init_set_str(mpz, str.c_str(), 10)) {
+big_integer_gmp::big_integer_gmp(const std::string& str) : big_integer_gmp(str, 10) {}
+
+big_integer_gmp::big_integer_gmp(const std::string& str, int base) {
+  if (mpz_init_set_str(mpz, str.c_str(), base)) {
     mpz_clear(mpz);
     throw std::runtime_error("invalid string");
   }
@@ -185,8 +187,62 @@ bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp, const big_integer_gmp& mod) {
+  big_integer_gmp res;
+  mpz_powm(res.mpz, base.mpz, exp.mpz, mod.mpz);
+  return res;
+}
+
+big_integer_gmp gcd(const big_integer_gmp& a, const big_integer_gmp& b) {
+  big_integer_gmp res;
+  mpz_gcd(res.mpz, a.mpz, b.mpz);
+  return res;
+}
+
+big_integer_gmp mod_inverse(const big_integer_gmp& a, const big_integer_gmp& mod) {
+  big_integer_gmp res;
+  if (mpz_invert(res.mpz, a.mpz, mod.mpz) == 0) {
+    mpz_set_ui(res.mpz, 0);
+  }
+  return res;
+}
+
+big_integer_gmp isqrt(const big_integer_gmp& a) {
+  big_integer_gmp res;
+  mpz_sqrt(res.mpz, a.mpz);
+  return res;
+}
+
+big_integer_gmp iroot(const big_integer_gmp& a, unsigned k) {
+  big_integer_gmp res;
+  mpz_root(res.mpz, a.mpz, k);
+  return res;
+}
+
+big_integer_gmp big_integer_gmp::factorial(unsigned long n) {
+  big_integer_gmp res;
+  mpz_fac_ui(res.mpz, n);
+  return res;
+}
+
+big_integer_gmp big_integer_gmp::binomial(unsigned long n, unsigned long k) {
+  big_integer_gmp res;
+  mpz_bin_uiui(res.mpz, n, k);
+  return res;
+}
+
+big_integer_gmp big_integer_gmp::primorial(unsigned long n) {
+  big_integer_gmp res;
+  mpz_primorial_ui(res.mpz, n);
+  return res;
+}
+
 std::string to_string(const big_integer_gmp& a) {
-  char* tmp = mpz_get_str(nullptr, 10, a.mpz);
+  return to_string(a, 10);
+}
+
+std::string to_string(const big_integer_gmp& a, int base) {
+  char* tmp = mpz_get_str(nullptr, base, a.mpz);
   std::string res = tmp;
 
   void (*freefunc)(void*, size_t);
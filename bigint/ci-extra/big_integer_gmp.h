@@ -10,6 +10,7 @@ struct big_integer_gmp {
   big_integer_gmp(const big_integer_gmp& other);
   big_integer_gmp(int a);
   explicit big_integer_gmp(const std::string& str);
+  big_integer_gmp(const std::string& str, int base);
 
   template <typename RNG>
   big_integer_gmp& random(size_t sz, RNG&& rng) {
@@ -51,6 +52,11 @@ struct big_integer_gmp {
   big_integer_gmp& operator--();
   big_integer_gmp operator--(int);
 
+  // members, as free functions they would take the same arguments as the big_integer ones
+  static big_integer_gmp factorial(unsigned long n);
+  static big_integer_gmp binomial(unsigned long n, unsigned long k);
+  static big_integer_gmp primorial(unsigned long n);
+
   friend bool operator==(const big_integer_gmp& a, const big_integer_gmp& b);
   friend bool operator!=(const big_integer_gmp& a, const big_integer_gmp& b);
   friend bool operator<(const big_integer_gmp& a, const big_integer_gmp& b);
@@ -59,6 +65,12 @@ struct big_integer_gmp {
   friend bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b);
 
   friend std::string to_string(const big_integer_gmp& a);
+  friend std::string to_string(const big_integer_gmp& a, int base);
+  friend big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp, const big_integer_gmp& mod);
+  friend big_integer_gmp gcd(const big_integer_gmp& a, const big_integer_gmp& b);
+  friend big_integer_gmp mod_inverse(const big_integer_gmp& a, const big_integer_gmp& mod);
+  friend big_integer_gmp isqrt(const big_integer_gmp& a);
+  friend big_integer_gmp iroot(const big_integer_gmp& a, unsigned k);
 
 private:
   mpz_t mpz;
@@ -85,4 +97,10 @@ bool operator<=(const big_integer_gmp& a, const big_integer_gmp& b);
 bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b);
 
 std::string to_string(const big_integer_gmp& a);
+std::string to_string(const big_integer_gmp& a, int base);
+big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp, const big_integer_gmp& mod);
+big_integer_gmp gcd(const big_integer_gmp& a, const big_integer_gmp& b);
+big_integer_gmp mod_inverse(const big_integer_gmp& a, const big_integer_gmp& mod);
+big_integer_gmp isqrt(const big_integer_gmp& a);
+big_integer_gmp iroot(const big_integer_gmp& a, unsigned k);
 std::ostream& operator<<(std::ostream& s, const big_integer_gmp& a);
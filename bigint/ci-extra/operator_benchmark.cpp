@@ -0,0 +1,311 @@
+// Sweeps the operand size from one to a million 64-bit limbs for every operator of big_integer and
+// prints ns/op and limbs/s next to the same operator of big_integer_gmp. Operands of n limbs are random
+// numbers of 64 * n bits, dividends are twice as long.
+//
+//   operator-benchmark [--max-limbs N] [--budget SECONDS] [--csv FILE] [--baseline FILE] [--tolerance RATIO]
+//
+// An operator stops growing once one call of it takes longer than the budget. --csv writes every
+// measurement as a line of "operator,limbs,implementation,ns_per_op,limbs_per_s". --baseline reads such a
+// file from an earlier build, prints the big_integer operators that got slower than the tolerance and
+// exits with 1 if there are any. The big_integer sizes of the baseline are measured past the budget, and
+// one left unmeasured, e.g. above --max-limbs, counts as a regression.
+
+#include "../big_integer.h"
+#include "big_integer_gmp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+// every measurement repeats the operator for at least this long
+constexpr double MIN_TIME_NS = 2e8;
+// shift of shl and shr, not a multiple of the limb to take the slow path
+constexpr int SHIFT = 67;
+
+enum operation { ADD, SUB, MUL, SQR, DIV, MOD, AND, OR, XOR, SHL, SHR, EQUAL, LESS, TO_STRING, FROM_STRING, COUNT };
+
+const char* const OPERATION_NAMES[COUNT] = {"add", "sub", "mul", "sqr", "div", "mod", "and", "or",
+                                            "xor", "shl", "shr", "equal", "less", "to_string", "from_string"};
+
+const char* const IMPLEMENTATION_NAMES[2] = {"big_integer", "gmp"};
+
+template <typename Number>
+struct operands {
+  Number a;
+  Number b;
+  Number a_copy;
+  Number wide;
+  std::string decimal;
+};
+
+const void* volatile number_sink;
+volatile bool bool_sink;
+
+template <typename Number>
+void run(operation op, const operands<Number>& x) {
+  switch (op) {
+  case ADD: {
+    Number r = x.a + x.b;
+    number_sink = &r;
+    break;
+  }
+  case SUB: {
+    Number r = x.a - x.b;
+    number_sink = &r;
+    break;
+  }
+  case MUL: {
+    Number r = x.a * x.b;
+    number_sink = &r;
+    break;
+  }
+  case SQR: {
+    Number r = x.a * x.a;
+    number_sink = &r;
+    break;
+  }
+  case DIV: {
+    Number r = x.wide / x.b;
+    number_sink = &r;
+    break;
+  }
+  case MOD: {
+    Number r = x.wide % x.b;
+    number_sink = &r;
+    break;
+  }
+  case AND: {
+    Number r = x.a & x.b;
+    number_sink = &r;
+    break;
+  }
+  case OR: {
+    Number r = x.a | x.b;
+    number_sink = &r;
+    break;
+  }
+  case XOR: {
+    Number r = x.a ^ x.b;
+    number_sink = &r;
+    break;
+  }
+  case SHL: {
+    Number r = x.a << SHIFT;
+    number_sink = &r;
+    break;
+  }
+  case SHR: {
+    Number r = x.a >> SHIFT;
+    number_sink = &r;
+    break;
+  }
+  // equal numbers, so that every limb is compared
+  case EQUAL:
+    bool_sink = x.a == x.a_copy;
+    break;
+  case LESS:
+    bool_sink = x.a < x.a_copy;
+    break;
+  case TO_STRING: {
+    std::string s = to_string(x.a);
+    number_sink = s.data();
+    break;
+  }
+  case FROM_STRING: {
+    Number r(x.decimal);
+    number_sink = &r;
+    break;
+  }
+  case COUNT:
+    break;
+  }
+}
+
+// the time of one call in ns, calls f in doubling batches to keep the clock out of small operators
+template <typename F>
+double time_per_call(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  size_t calls = 0;
+  for (size_t batch = 1;; batch *= 2) {
+    for (size_t i = 0; i < batch; ++i) {
+      f();
+    }
+    calls += batch;
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (elapsed >= MIN_TIME_NS) {
+      return elapsed / calls;
+    }
+  }
+}
+
+std::string random_hex(size_t limbs, std::mt19937_64& rng) {
+  std::string s(limbs * 16, '0');
+  for (char& c : s) {
+    c = "0123456789abcdef"[rng() % 16];
+  }
+  s[0] = '8';
+  return s;
+}
+
+template <typename Number>
+operands<Number> make_operands(const std::string& a, const std::string& b, const std::string& wide,
+                               const std::string& decimal) {
+  return {Number(a, 16), Number(b, 16), Number(a, 16), Number(wide, 16), decimal};
+}
+
+std::vector<size_t> make_sizes(size_t max_limbs) {
+  std::vector<size_t> sizes;
+  for (size_t scale = 1; scale <= max_limbs; scale *= 10) {
+    for (size_t step : {1, 2, 5}) {
+      if (scale * step <= max_limbs) {
+        sizes.push_back(scale * step);
+      }
+    }
+  }
+  return sizes;
+}
+
+using measurement_key = std::tuple<std::string, size_t, std::string>;
+
+std::map<measurement_key, double> read_csv(const char* path) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "can't open %s\n", path);
+    std::exit(2);
+  }
+  std::map<measurement_key, double> res;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string name, limbs, implementation, ns;
+    if (std::getline(fields, name, ',') && std::getline(fields, limbs, ',') &&
+        std::getline(fields, implementation, ',') && std::getline(fields, ns, ',') && name != "operator") {
+      res[{name, std::stoul(limbs), implementation}] = std::stod(ns);
+    }
+  }
+  return res;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t max_limbs = 1000000;
+  double budget_ns = 1e9;
+  const char* csv_path = nullptr;
+  const char* baseline_path = nullptr;
+  double tolerance = 1.25;
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 == argc) {
+      std::fprintf(stderr, "%s needs a value\n", argv[i]);
+      return 2;
+    }
+    if (std::strcmp(argv[i], "--max-limbs") == 0) {
+      max_limbs = std::strtoul(argv[i + 1], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--budget") == 0) {
+      budget_ns = std::strtod(argv[i + 1], nullptr) * 1e9;
+    } else if (std::strcmp(argv[i], "--csv") == 0) {
+      csv_path = argv[i + 1];
+    } else if (std::strcmp(argv[i], "--baseline") == 0) {
+      baseline_path = argv[i + 1];
+    } else if (std::strcmp(argv[i], "--tolerance") == 0) {
+      tolerance = std::strtod(argv[i + 1], nullptr);
+    } else {
+      std::fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  std::map<measurement_key, double> baseline;
+  if (baseline_path) {
+    baseline = read_csv(baseline_path);
+  }
+
+  std::map<measurement_key, double> results;
+  bool over_budget[COUNT][2] = {};
+  std::mt19937_64 rng(322);
+  for (size_t limbs : make_sizes(max_limbs)) {
+    std::string a = random_hex(limbs, rng);
+    std::string b = random_hex(limbs, rng);
+    std::string wide = random_hex(2 * limbs, rng);
+    big_integer_gmp gmp_a(a, 16);
+    std::string decimal = to_string(gmp_a);
+    operands<big_integer> ours = make_operands<big_integer>(a, b, wide, decimal);
+    operands<big_integer_gmp> theirs = make_operands<big_integer_gmp>(a, b, wide, decimal);
+
+    std::printf("%zu limbs:\n", limbs);
+    std::printf("  %-12s %14s %14s %14s %14s %8s\n", "operator", "ns/op", "limbs/s", "gmp ns/op", "gmp limbs/s",
+                "vs gmp");
+    for (size_t op = 0; op < COUNT; ++op) {
+      double ns[2] = {};
+      for (size_t impl = 0; impl < 2; ++impl) {
+        measurement_key key{OPERATION_NAMES[op], limbs, IMPLEMENTATION_NAMES[impl]};
+        if (over_budget[op][impl] && (impl != 0 || baseline.count(key) == 0)) {
+          continue;
+        }
+        ns[impl] = impl == 0 ? time_per_call([&] { run(static_cast<operation>(op), ours); })
+                             : time_per_call([&] { run(static_cast<operation>(op), theirs); });
+        over_budget[op][impl] = ns[impl] > budget_ns;
+        results[key] = ns[impl];
+      }
+      if (ns[0] == 0 && ns[1] == 0) {
+        continue;
+      }
+      std::printf("  %-12s", OPERATION_NAMES[op]);
+      for (double t : ns) {
+        if (t == 0) {
+          std::printf(" %14s %14s", "-", "-");
+        } else {
+          std::printf(" %14.1f %14.4g", t, limbs * 1e9 / t);
+        }
+      }
+      if (ns[0] != 0 && ns[1] != 0) {
+        std::printf(" %7.2fx", ns[0] / ns[1]);
+      }
+      std::printf("\n");
+      std::fflush(stdout);
+    }
+  }
+
+  if (csv_path) {
+    std::ofstream out(csv_path);
+    out << "operator,limbs,implementation,ns_per_op,limbs_per_s\n";
+    for (const auto& [key, ns] : results) {
+      const auto& [name, limbs, implementation] = key;
+      out << name << ',' << limbs << ',' << implementation << ',' << ns << ',' << limbs * 1e9 / ns << '\n';
+    }
+  }
+
+  if (baseline_path) {
+    size_t regressions = 0;
+    for (const auto& [key, old_ns] : baseline) {
+      const auto& [name, limbs, implementation] = key;
+      if (implementation != IMPLEMENTATION_NAMES[0]) {
+        continue;
+      }
+      auto it = results.find(key);
+      if (it == results.end()) {
+        std::printf("regression: %s on %zu limbs wasn't measured, %.1f ns/op before\n", name.c_str(), limbs, old_ns);
+        ++regressions;
+        continue;
+      }
+      if (it->second <= old_ns * tolerance) {
+        continue;
+      }
+      std::printf("regression: %s on %zu limbs, %.1f ns/op instead of %.1f (x%.2f)\n", name.c_str(), limbs,
+                  it->second, old_ns, it->second / old_ns);
+      ++regressions;
+    }
+    if (regressions != 0) {
+      return 1;
+    }
+  }
+}
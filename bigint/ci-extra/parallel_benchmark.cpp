@@ -0,0 +1,68 @@
+// Times multiplication and decimal conversion of numbers with millions of decimal digits under
+// big_integer_parallel_scope for growing pools and prints the speedup over the single-threaded run.
+// The pool sizes go up to the number of hardware threads or to the first command line argument.
+
+#include "../big_integer.h"
+#include "../thread_pool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+template <typename F>
+double measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+big_integer make_number(int bits, int salt) {
+  big_integer a = 1;
+  while (bits > 0) {
+    int len = std::min(bits, 1 << 20);
+    a = (a << len) + (((big_integer(1) << len) - salt) / (2 * salt + 1));
+    bits -= len;
+  }
+  return a;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+  std::vector<size_t> pools{0};
+  for (size_t threads = 1; threads < max_threads; threads *= 2) {
+    pools.push_back(threads);
+  }
+  if (max_threads > 1) {
+    pools.push_back(max_threads - 1);
+  }
+
+  for (int bits : {1 << 22, 1 << 24}) {
+    big_integer a = make_number(bits, 3);
+    big_integer b = make_number(bits, 5);
+    std::string s = to_string(a);
+    std::printf("%d bits (%zu decimal digits):\n", bits, s.size());
+    std::printf("  %8s %14s %14s %14s\n", "threads", "a * b, ms", "to_string, ms", "from string, ms");
+    double base[3] = {};
+    for (size_t workers : pools) {
+      thread_pool pool(workers);
+      big_integer_parallel_scope scope(&pool);
+      double t[3] = {measure([&] { big_integer c = a * b; }), measure([&] { std::string r = to_string(a); }),
+                     measure([&] { big_integer c(s); })};
+      if (workers == 0) {
+        std::copy(t, t + 3, base);
+      }
+      // the calling thread works too, so a pool of n workers runs n + 1 threads
+      std::printf("  %8zu", workers + 1);
+      for (size_t i = 0; i < 3; ++i) {
+        std::printf(" %8.1f x%4.2f", t[i], base[i] / t[i]);
+      }
+      std::printf("\n");
+      std::fflush(stdout);
+    }
+  }
+}
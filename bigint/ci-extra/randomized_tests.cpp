@@ -244,3 +244,164 @@ TEST(correctness_random, bit_shifts) {
     EXPECT_EQ(to_string(a >> shift), to_string(R >> shift));
   }
 }
+
+TEST(correctness_random, mul_large) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, b;
+    a.random(MAX_SIZE * (itn + 1) * 2, rng);
+    b.random(MAX_SIZE * (NUMBER_OF_ITERATIONS - itn) + rng() % MAX_SIZE, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, sqr_large) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a;
+    a.random(MAX_SIZE * (itn + 1) * 2 + rng() % MAX_SIZE, rng);
+    big_integer_gmp c = a * a;
+    big_integer A = big_integer(to_string(a));
+    big_integer R = A * A;
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, mul_huge) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != 2; ++itn) {
+    big_integer_gmp a, b;
+    a.random(MAX_SIZE * 160 + rng() % MAX_SIZE, rng);
+    b.random(MAX_SIZE * (144 + 16 * itn) + rng() % MAX_SIZE, rng);
+    // decimal conversion would cost more than the products, hex is linear
+    big_integer A = big_integer(to_string(a, 16), 16);
+    big_integer B = big_integer(to_string(b, 16), 16);
+    EXPECT_EQ(to_string(a * b, 16), to_string(A * B, 16));
+    EXPECT_EQ(to_string(a * a, 16), to_string(A * A, 16));
+  }
+}
+
+TEST(correctness_random, div_large) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, b;
+    a.random(MAX_SIZE * 8 + rng() % MAX_SIZE, rng);
+    b.random(MAX_SIZE * (itn + 1) / 2 + rng() % 64, rng);
+    big_integer A = big_integer(to_string(a));
+    big_integer B = big_integer(to_string(b));
+    EXPECT_EQ(big_integer(to_string(a / b)), A / B);
+    EXPECT_EQ(big_integer(to_string(a % b)), A % B);
+  }
+}
+
+TEST(correctness_random, pow_mod) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, e, m;
+    a.random(MAX_SIZE, rng);
+    e.random(rng() % MAX_SIZE, rng);
+    m.random(rng() % (MAX_SIZE * (itn + 1) / NUMBER_OF_ITERATIONS) + 1, rng);
+    if (e < 0) {
+      e = -e;
+    }
+    if (m == 0) {
+      m = 1;
+    }
+    big_integer A = big_integer(to_string(a));
+    big_integer E = big_integer(to_string(e));
+    big_integer M = big_integer(to_string(m));
+    EXPECT_EQ(big_integer(to_string(pow_mod(a, e, m))), pow_mod(A, E, M));
+  }
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, b, c;
+    a.random(rng() % (MAX_SIZE * (itn + 1)), rng);
+    b.random(rng() % (MAX_SIZE * (itn + 1)), rng);
+    c.random(rng() % MAX_SIZE, rng);
+    a = a * c;
+    b = b * c;
+    big_integer A = big_integer(to_string(a));
+    big_integer B = big_integer(to_string(b));
+    big_integer G = big_integer(to_string(gcd(a, b)));
+    EXPECT_EQ(gcd(A, B), G);
+    auto [g, x, y] = xgcd(A, B);
+    EXPECT_EQ(g, G);
+    EXPECT_EQ(A * x + B * y, G);
+  }
+}
+
+TEST(correctness_random, mod_inverse) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, m;
+    a.random(rng() % (MAX_SIZE * 4), rng);
+    m.random(rng() % (MAX_SIZE * (itn + 1)), rng);
+    if (m == 0 || m == 1 || m == -1) {
+      m = 2;
+    }
+    big_integer A = big_integer(to_string(a));
+    big_integer M = big_integer(to_string(m));
+    EXPECT_EQ(big_integer(to_string(mod_inverse(a, m))), mod_inverse(A, M));
+  }
+}
+
+TEST(correctness_random, roots) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS * 4; ++itn) {
+    big_integer_gmp a;
+    a.random(rng() % (MAX_SIZE * (itn % NUMBER_OF_ITERATIONS + 1)), rng);
+    if (a < 0) {
+      a = -a;
+    }
+    unsigned k = rng() % 10 + 1;
+    big_integer A = big_integer(to_string(a, 16), 16);
+    EXPECT_EQ(to_string(isqrt(a), 16), to_string(isqrt(A), 16));
+    EXPECT_EQ(to_string(iroot(a, k), 16), to_string(iroot(A, k), 16));
+    EXPECT_EQ(to_string(iroot(-a, 2 * k + 1), 16), to_string(iroot(-A, 2 * k + 1), 16));
+  }
+}
+
+TEST(correctness_random, radix) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS * 3; ++itn) {
+    big_integer_gmp a;
+    a.random(rng() % (MAX_SIZE * (itn % NUMBER_OF_ITERATIONS + 1)), rng);
+    int base = 2 << (itn % 5);
+    big_integer A = big_integer(to_string(a));
+    std::string s = to_string(a, base);
+    EXPECT_EQ(to_string(A, base), s);
+    EXPECT_EQ(big_integer(s, base), A);
+  }
+}
+
+TEST(correctness_random, factorial) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    unsigned n = rng() % (MAX_SIZE * 10);
+    unsigned k = rng() % (n + 2);
+    EXPECT_EQ(to_string(big_integer_gmp::factorial(n), 16), to_string(factorial(n), 16));
+    EXPECT_EQ(to_string(big_integer_gmp::binomial(n, k), 16), to_string(binomial(n, k), 16));
+    EXPECT_EQ(to_string(big_integer_gmp::primorial(n), 16), to_string(primorial(n), 16));
+  }
+}
+
+TEST(correctness_random, addmul) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
+    big_integer_gmp a, b, c;
+    a.random(rng() % (MAX_SIZE * 4), rng);
+    b.random(rng() % (MAX_SIZE * (itn + 1)), rng);
+    c.random(rng() % MAX_SIZE, rng);
+    big_integer A = big_integer(to_string(a));
+    big_integer B = big_integer(to_string(b));
+    big_integer C = big_integer(to_string(c));
+    EXPECT_EQ(big_integer(to_string(a + b * c)), big_integer(A) += B * C);
+    EXPECT_EQ(big_integer(to_string(a - b * c)), big_integer(A) -= B * C);
+    EXPECT_EQ(big_integer(to_string(b * c - a)), B * C - A);
+  }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Unsigned number of exactly Bits bits in 64-bit limbs kept inline. Arithmetic wraps around modulo 2^Bits like
+// that of the builtin unsigned types. Operations run over every limb in loops unrolled at compile time, with no
+// normalization, no branches on the values and no allocation, and all of them work in constant expressions.
+template <size_t Bits>
+class fixed_big_integer {
+  static_assert(Bits > 0 && Bits % 64 == 0, "the width has to be a whole number of 64-bit limbs");
+
+public:
+  using limb = uint64_t;
+  static constexpr size_t LIMBS = Bits / 64;
+
+  constexpr fixed_big_integer() noexcept = default;
+  constexpr fixed_big_integer(limb a) noexcept : _limbs{a} {}
+  // the limbs from the lowest one
+  constexpr explicit fixed_big_integer(const std::array<limb, LIMBS>& limbs) noexcept : _limbs(limbs) {}
+
+  // a modulo 2^Bits, negative numbers wrap around like on conversion to an unsigned type
+  explicit fixed_big_integer(const big_integer& a) {
+    for (size_t i = 0; i < a.data.size() && i < LIMBS * DIGITS_PER_LIMB; ++i) {
+      _limbs[i / DIGITS_PER_LIMB] |= static_cast<limb>(a.data[i]) << (i % DIGITS_PER_LIMB * DIGIT_BITS);
+    }
+    if (a.is_negative()) {
+      *this = -*this;
+    }
+  }
+
+  explicit operator big_integer() const {
+    std::array<big_integer::digit, LIMBS * DIGITS_PER_LIMB> digits;
+    for (size_t i = 0; i < digits.size(); ++i) {
+      digits[i] = static_cast<big_integer::digit>(_limbs[i / DIGITS_PER_LIMB] >> (i % DIGITS_PER_LIMB * DIGIT_BITS));
+    }
+    big_integer res;
+    res.data.assign(digits.begin(), digits.end());
+    res.shrink();
+    return res;
+  }
+
+  constexpr const std::array<limb, LIMBS>& limbs() const noexcept {
+    return _limbs;
+  }
+
+  constexpr fixed_big_integer& operator+=(const fixed_big_integer& rhs) noexcept {
+    limb carry = 0;
+    unrolled([&](size_t i) {
+      limb sum = _limbs[i] + rhs._limbs[i];
+      limb overflow = sum < rhs._limbs[i];
+      _limbs[i] = sum + carry;
+      carry = overflow | (_limbs[i] < carry);
+    });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator-=(const fixed_big_integer& rhs) noexcept {
+    sub_borrow(rhs);
+    return *this;
+  }
+
+  // the lower half of the product, a row of the schoolbook product per limb of rhs
+  constexpr fixed_big_integer& operator*=(const fixed_big_integer& rhs) noexcept {
+    std::array<limb, LIMBS> r{};
+    for (size_t j = 0; j < LIMBS; ++j) {
+      limb carry = 0;
+      unrolled([&](size_t i) {
+        if (i + j < LIMBS) {
+          wide_limb cur = static_cast<wide_limb>(_limbs[i]) * rhs._limbs[j] + r[i + j] + carry;
+          r[i + j] = static_cast<limb>(cur);
+          carry = static_cast<limb>(cur >> 64);
+        }
+      });
+    }
+    _limbs = r;
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator&=(const fixed_big_integer& rhs) noexcept {
+    unrolled([&](size_t i) { _limbs[i] &= rhs._limbs[i]; });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator|=(const fixed_big_integer& rhs) noexcept {
+    unrolled([&](size_t i) { _limbs[i] |= rhs._limbs[i]; });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator^=(const fixed_big_integer& rhs) noexcept {
+    unrolled([&](size_t i) { _limbs[i] ^= rhs._limbs[i]; });
+    return *this;
+  }
+
+  // shifts by Bits or more give zero
+  constexpr fixed_big_integer& operator<<=(size_t shift) noexcept {
+    std::array<limb, LIMBS> r{};
+    size_t limbs = shift / 64;
+    size_t bits = shift % 64;
+    unrolled([&](size_t i) {
+      if (i >= limbs) {
+        r[i] = _limbs[i - limbs] << bits;
+        if (bits != 0 && i > limbs) {
+          r[i] |= _limbs[i - limbs - 1] >> (64 - bits);
+        }
+      }
+    });
+    _limbs = r;
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator>>=(size_t shift) noexcept {
+    std::array<limb, LIMBS> r{};
+    size_t limbs = shift / 64;
+    size_t bits = shift % 64;
+    unrolled([&](size_t i) {
+      if (i + limbs < LIMBS) {
+        r[i] = _limbs[i + limbs] >> bits;
+        if (bits != 0 && i + limbs + 1 < LIMBS) {
+          r[i] |= _limbs[i + limbs + 1] << (64 - bits);
+        }
+      }
+    });
+    _limbs = r;
+    return *this;
+  }
+
+  constexpr fixed_big_integer operator~() const noexcept {
+    fixed_big_integer res;
+    unrolled([&](size_t i) { res._limbs[i] = ~_limbs[i]; });
+    return res;
+  }
+
+  constexpr fixed_big_integer operator-() const noexcept {
+    return fixed_big_integer() - *this;
+  }
+
+  friend constexpr fixed_big_integer operator+(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a += b;
+  }
+
+  friend constexpr fixed_big_integer operator-(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a -= b;
+  }
+
+  friend constexpr fixed_big_integer operator*(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a *= b;
+  }
+
+  friend constexpr fixed_big_integer operator&(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a &= b;
+  }
+
+  friend constexpr fixed_big_integer operator|(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a |= b;
+  }
+
+  friend constexpr fixed_big_integer operator^(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a ^= b;
+  }
+
+  friend constexpr fixed_big_integer operator<<(fixed_big_integer a, size_t shift) noexcept {
+    return a <<= shift;
+  }
+
+  friend constexpr fixed_big_integer operator>>(fixed_big_integer a, size_t shift) noexcept {
+    return a >>= shift;
+  }
+
+  friend constexpr bool operator==(const fixed_big_integer& a, const fixed_big_integer& b) noexcept = default;
+
+  // from the borrows of a - b and b - a instead of a search for the highest differing limb
+  friend constexpr std::strong_ordering operator<=>(const fixed_big_integer& a, const fixed_big_integer& b) noexcept {
+    fixed_big_integer a_copy = a;
+    fixed_big_integer b_copy = b;
+    bool less = a_copy.sub_borrow(b);
+    bool greater = b_copy.sub_borrow(a);
+    return static_cast<int>(greater) <=> static_cast<int>(less);
+  }
+
+private:
+  __extension__ typedef unsigned __int128 wide_limb;
+
+  static constexpr size_t DIGIT_BITS = 8 * sizeof(big_integer::digit);
+  static constexpr size_t DIGITS_PER_LIMB = 64 / DIGIT_BITS;
+
+  // f(0), f(1), ..., f(LIMBS - 1) without a loop
+  template <typename F>
+  static constexpr void unrolled(F&& f) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (f(I), ...);
+    }(std::make_index_sequence<LIMBS>{});
+  }
+
+  // this -= rhs, returns the borrow out of the top limb
+  constexpr bool sub_borrow(const fixed_big_integer& rhs) noexcept {
+    limb borrow = 0;
+    unrolled([&](size_t i) {
+      limb diff = _limbs[i] - rhs._limbs[i];
+      limb underflow = _limbs[i] < rhs._limbs[i];
+      _limbs[i] = diff - borrow;
+      borrow = underflow | (diff < borrow);
+    });
+    return borrow != 0;
+  }
+
+  std::array<limb, LIMBS> _limbs{};
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Small vectors constructed on this thread take their heap buffers from this resource when it is set
+// and from operator new otherwise. A vector keeps the resource it was constructed with for all its buffers,
+// like the std::pmr containers do.
+inline thread_local std::pmr::memory_resource* small_vector_resource = nullptr;
+
+#ifdef BIGINT_INSTRUMENTATION
+// heap buffers allocated by small vectors on this thread, read by the big_integer statistics
+inline thread_local size_t small_vector_allocations = 0;
+#endif
+
+// Vector of trivially copyable values that keeps up to SMALL_SIZE of them inline
+// and moves to the heap only when it grows beyond that.
+template <typename T, size_t SMALL_SIZE>
+class small_vector {
+  static_assert(std::is_trivially_copyable_v<T>, "values are relocated with memcpy");
+  static_assert(SMALL_SIZE > 0);
+
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using pointer = T*;
+  using const_pointer = const T*;
+
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+public:
+  small_vector() noexcept : _size(0), _capacity(SMALL_SIZE), _resource(small_vector_resource) {}
+
+  explicit small_vector(size_t size, const T& value = T()) : small_vector() {
+    resize(size, value);
+  }
+
+  template <typename InputIt>
+  small_vector(InputIt first, InputIt last) : small_vector() {
+    assign(first, last);
+  }
+
+  small_vector(std::initializer_list<T> values) : small_vector(values.begin(), values.end()) {}
+
+  small_vector(const small_vector& other) : small_vector() {
+    assign(other.begin(), other.end());
+  }
+
+  // takes the resource of other along with its buffer
+  small_vector(small_vector&& other) noexcept : _size(0), _capacity(SMALL_SIZE), _resource(other._resource) {
+    steal(other);
+  }
+
+  small_vector& operator=(const small_vector& other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  // the buffer of other is taken only if it comes from the same resource, otherwise the values are copied
+  small_vector& operator=(small_vector&& other) {
+    if (this != &other) {
+      if (same_resource(other) || other.is_small()) {
+        release_data();
+        steal(other);
+      } else {
+        assign(other.begin(), other.end());
+        other.clear();
+      }
+    }
+    return *this;
+  }
+
+  ~small_vector() noexcept {
+    release_data();
+  }
+
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last) {
+    size_t count = std::distance(first, last);
+    if (count > capacity()) {
+      set_capacity(count, 0);
+    }
+    std::copy(first, last, begin());
+    _size = count;
+  }
+
+  reference operator[](size_t index) {
+    assert(index < size());
+    return data()[index];
+  }
+
+  const_reference operator[](size_t index) const {
+    assert(index < size());
+    return data()[index];
+  }
+
+  pointer data() noexcept {
+    return is_small() ? _small_data : _big_data;
+  }
+
+  const_pointer data() const noexcept {
+    return is_small() ? _small_data : _big_data;
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  bool is_small() const noexcept {
+    return _capacity == SMALL_SIZE;
+  }
+
+  reference front() {
+    assert(!empty());
+    return *begin();
+  }
+
+  const_reference front() const {
+    assert(!empty());
+    return *begin();
+  }
+
+  reference back() {
+    assert(!empty());
+    return *(end() - 1);
+  }
+
+  const_reference back() const {
+    assert(!empty());
+    return *(end() - 1);
+  }
+
+  void push_back(const T& value) {
+    if (size() == capacity()) {
+      T copy = value;
+      grow(size() + 1);
+      data()[_size++] = copy;
+    } else {
+      data()[_size++] = value;
+    }
+  }
+
+  void pop_back() {
+    assert(!empty());
+    --_size;
+  }
+
+  void resize(size_t new_size, const T& value = T()) {
+    if (new_size > capacity()) {
+      grow(new_size);
+    }
+    if (new_size > size()) {
+      std::fill(end(), begin() + new_size, value);
+    }
+    _size = new_size;
+  }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+      set_capacity(new_capacity, size());
+    }
+  }
+
+  void clear() noexcept {
+    _size = 0;
+  }
+
+  iterator insert(const_iterator pos, size_t count, const T& value) {
+    size_t index = pos - begin();
+    T copy = value;
+    if (size() + count > capacity()) {
+      grow(size() + count);
+    }
+    iterator first = begin() + index;
+    std::memmove(first + count, first, (size() - index) * sizeof(T));
+    std::fill(first, first + count, copy);
+    _size += count;
+    return first;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    size_t index = first - begin();
+    size_t count = last - first;
+    iterator pos = begin() + index;
+    std::memmove(pos, pos + count, (size() - index - count) * sizeof(T));
+    _size -= count;
+    return pos;
+  }
+
+  void swap(small_vector& other) {
+    small_vector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  iterator begin() noexcept {
+    return data();
+  }
+
+  const_iterator begin() const noexcept {
+    return data();
+  }
+
+  iterator end() noexcept {
+    return begin() + size();
+  }
+
+  const_iterator end() const noexcept {
+    return begin() + size();
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+
+  const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  friend bool operator==(const small_vector& a, const small_vector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+  friend bool operator!=(const small_vector& a, const small_vector& b) {
+    return !(a == b);
+  }
+
+  friend void swap(small_vector& a, small_vector& b) {
+    a.swap(b);
+  }
+
+private:
+  void grow(size_t min_capacity) {
+    set_capacity(std::max(min_capacity, 2 * capacity()), size());
+  }
+
+  // moves the first `keep` values to a heap buffer of new_capacity > SMALL_SIZE values
+  void set_capacity(size_t new_capacity, size_t keep) {
+    assert(new_capacity > SMALL_SIZE && keep <= new_capacity);
+    size_t bytes = new_capacity * sizeof(T);
+    T* new_data = static_cast<T*>(_resource ? _resource->allocate(bytes, alignof(T)) : operator new(bytes));
+#ifdef BIGINT_INSTRUMENTATION
+    ++small_vector_allocations;
+#endif
+    std::memcpy(new_data, data(), keep * sizeof(T));
+    release_data();
+    _big_data = new_data;
+    _capacity = new_capacity;
+  }
+
+  void release_data() noexcept {
+    if (!is_small()) {
+      if (_resource) {
+        _resource->deallocate(_big_data, _capacity * sizeof(T), alignof(T));
+      } else {
+        operator delete(_big_data);
+      }
+      _capacity = SMALL_SIZE;
+    }
+  }
+
+  bool same_resource(const small_vector& other) const noexcept {
+    return _resource == other._resource || (_resource && other._resource && _resource->is_equal(*other._resource));
+  }
+
+  // takes over the buffer of other, which becomes empty and small; this must not own a heap buffer and
+  // must have the resource of other unless other is small
+  void steal(small_vector& other) noexcept {
+    if (other.is_small()) {
+      std::memcpy(_small_data, other._small_data, other.size() * sizeof(T));
+    } else {
+      _big_data = other._big_data;
+      _resource = other._resource;
+    }
+    _size = std::exchange(other._size, 0);
+    _capacity = std::exchange(other._capacity, SMALL_SIZE);
+  }
+
+private:
+  size_t _size;
+  size_t _capacity;
+
+  std::pmr::memory_resource* _resource;
+
+  union {
+    T* _big_data;
+    T _small_data[SMALL_SIZE];
+  };
+};
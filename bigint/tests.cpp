@@ -1,12 +1,20 @@
 #include "big_integer.h"
+#include "fixed_big_integer.h"
+#include "thread_pool.h"
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -117,6 +125,47 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, move_ctor_and_assignment) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = std::move(a);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), b);
+  EXPECT_EQ(0, a);
+
+  a = std::move(b);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+  EXPECT_EQ(0, b);
+
+  b = 42;
+  EXPECT_EQ(42, b);
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("1234567890123456789012345678901234567890");
+  big_integer b("-987654321098765432109876543210");
+  big_integer c("55555555555555555555555555555555");
+  big_integer d("-3");
+  big_integer e("100000000000000000000000000000000000000000000000000");
+
+  big_integer ab = a * b;
+  big_integer cd = c * d;
+  big_integer expected = ab;
+  expected += cd;
+  expected -= e;
+  EXPECT_EQ(expected, a * b + c * d - e);
+  EXPECT_EQ(expected, -(e - c * d - a * b));
+  EXPECT_EQ(e - ab, e - a * b);
+  EXPECT_EQ(ab - cd, a * b - c * d);
+  EXPECT_EQ(-ab, -(a * b));
+  EXPECT_EQ(~ab, ~(a * b));
+  EXPECT_EQ(ab & c, (a * b) & c);
+  EXPECT_EQ(ab | c, c | (a * b));
+  EXPECT_EQ(ab ^ cd, (a * b) ^ (c * d));
+  EXPECT_EQ(ab << 77, (a * b) << 77);
+  EXPECT_EQ(ab >> 77, (a * b) >> 77);
+  EXPECT_EQ(ab / c, (a * b) / c);
+  EXPECT_EQ(ab % c, (a * b) % c);
+}
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -442,6 +491,7 @@ TEST(correctness, shl_) {
 
   a <<= 5;
   EXPECT_TRUE(a == 23 * 32);
+  EXPECT_TRUE((big_integer(0) << 100) == 0);
 }
 
 TEST(correctness, shl_return_value) {
@@ -583,6 +633,16 @@ TEST(correctness, mul_long_pow2) {
   EXPECT_EQ(c, b * b);
 }
 
+TEST(correctness, mul_long_pow2_minus_one) {
+  for (int n : {1000, 5000, 12345, 28671, 40000, 400000}) {
+    big_integer a = (big_integer(1) << n) - 1;
+    big_integer b = (big_integer(1) << (n / 3 + 7)) - 1;
+    EXPECT_EQ((big_integer(1) << (2 * n)) - (big_integer(1) << (n + 1)) + 1, a * a);
+    EXPECT_EQ((big_integer(1) << (2 * n)) - 3 * (big_integer(1) << n) + 2, a * (a - 1));
+    EXPECT_EQ((big_integer(1) << (n + n / 3 + 7)) - (big_integer(1) << n) - (big_integer(1) << (n / 3 + 7)) + 1, a * b);
+  }
+}
+
 TEST(correctness, div_0_long) {
   big_integer a;
   big_integer b("100000000000000000000000000000000000000000000000000000000000");
@@ -616,6 +676,30 @@ TEST(correctness, div_long_signed2) {
   EXPECT_EQ(c, a / b);
 }
 
+TEST(correctness, div_long_add_back) {
+  // the estimated quotient digit is one too large and has to be corrected after subtraction
+  big_integer a = (big_integer(0x7fffffff) << 96) + (big_integer(0x80000000) << 64);
+  big_integer b = (big_integer(0x80000000) << 64) + 1;
+  big_integer q = 0xfffffffe;
+  big_integer r = (big_integer(0x7fffffff) << 64) + (big_integer(0xffffffff) << 32) + 2;
+
+  EXPECT_EQ(q, a / b);
+  EXPECT_EQ(r, a % b);
+}
+
+TEST(correctness, div_mod_long_identity) {
+  for (int n : {20000, 400000}) {
+    big_integer a = (big_integer(1) << n) - 12345;
+    big_integer b = ((big_integer(1) << (n / 3)) + (big_integer(1) << (n / 7)) - 1) * 1234567891;
+
+    big_integer q = a / b;
+    big_integer r = a % b;
+    EXPECT_EQ(a, q * b + r);
+    EXPECT_LE(0, r);
+    EXPECT_LT(r, b);
+  }
+}
+
 TEST(correctness, negation_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000");
   big_integer c("-10000000000000000000000000000000000000000000000000000");
@@ -647,6 +731,31 @@ TEST(correctness, shr_long) {
             big_integer("-3417856182746231874623148723164812376512852437523846123876") >> 31);
 }
 
+TEST(correctness, bitwise_long) {
+  // lengths around multiples of a vector register, low digits that are all zero or all ones
+  std::vector<big_integer> values{0};
+  for (int bits : {31, 64, 200, 255, 256, 257, 1000, 4099}) {
+    big_integer p = big_integer(1) << bits;
+    for (const big_integer& a : {p, p - 1, p / 3, p * 5 + 7, (p + 1) << 70}) {
+      values.push_back(a);
+      values.push_back(-a);
+    }
+  }
+  for (const big_integer& a : values) {
+    for (const big_integer& b : values) {
+      EXPECT_EQ((a & b) + (a | b), a + b);
+      EXPECT_EQ((a | b) - (a & b), a ^ b);
+      EXPECT_EQ(~(a & b), ~a | ~b);
+      EXPECT_EQ(a ^ b ^ b, a);
+    }
+    for (int shift : {0, 1, 31, 32, 33, 63, 64, 65, 300, 4100}) {
+      big_integer p = big_integer(1) << shift;
+      EXPECT_EQ(a << shift, a * p);
+      EXPECT_EQ(a >> shift, a / p - (a % p < 0 ? 1 : 0));
+    }
+  }
+}
+
 TEST(correctness, string_conv) {
   EXPECT_EQ("100", to_string(big_integer("100")));
   EXPECT_EQ("100", to_string(big_integer("0100")));
@@ -674,6 +783,23 @@ void test_converting_ctor(T value) {
 }
 } // namespace
 
+TEST(correctness, string_conv_long) {
+  for (size_t n : {100, 1000, 12345, 40000}) {
+    std::string pow10 = "1" + std::string(n, '0');
+    big_integer a(pow10);
+    EXPECT_EQ(pow10, to_string(a));
+    EXPECT_EQ(std::string(n, '9'), to_string(a - 1));
+    EXPECT_EQ("-" + std::string(n, '9'), to_string(1 - a));
+    EXPECT_EQ(a, big_integer("000" + pow10));
+
+    std::string digits;
+    for (size_t i = 0; i < n; ++i) {
+      digits += static_cast<char>('1' + i * 7 % 9);
+    }
+    EXPECT_EQ(digits, to_string(big_integer(digits)));
+  }
+}
+
 TEST(correctness, converting_ctor) {
   using std::numeric_limits;
 
@@ -728,3 +854,681 @@ TEST(correctness, converting_ctor4) {
 
   EXPECT_EQ(to_string(bignum), std::to_string(num));
 }
+
+TEST(correctness, pow_mod) {
+  EXPECT_EQ(pow_mod(2, 10, 1000), 24);
+  EXPECT_EQ(pow_mod(3, 0, 7), 1);
+  EXPECT_EQ(pow_mod(0, 0, 7), 1);
+  EXPECT_EQ(pow_mod(0, 5, 7), 0);
+  EXPECT_EQ(pow_mod(5, 0, 1), 0);
+  EXPECT_EQ(pow_mod(5, 123, 1), 0);
+  EXPECT_EQ(pow_mod(-2, 3, 7), 6);
+  EXPECT_EQ(pow_mod(-2, 3, -7), 6);
+  EXPECT_EQ(pow_mod(10, 3, 16), 8);
+  EXPECT_EQ(pow_mod(3, 200, 1000000007), 136318165);
+  EXPECT_EQ(pow_mod(big_integer("12345678901234567890"), 65537, big_integer("98765432109876543211")),
+            big_integer("83337656697181353432"));
+}
+
+TEST(correctness, pow_mod_fermat) {
+  for (int p : {61, 89, 127, 521, 1279}) {
+    big_integer m = (big_integer(1) << p) - 1;
+    for (big_integer a : {big_integer(3), m - 1, (big_integer(1) << (p / 2)) + 12345}) {
+      EXPECT_EQ(pow_mod(a, m - 1, m), 1);
+      EXPECT_EQ(pow_mod(a, m, m), a % m);
+    }
+  }
+}
+
+TEST(correctness, pow_mod_long) {
+  big_integer m = (big_integer(1) << 1000) + 297;
+  big_integer a = (big_integer(1) << 777) - 1;
+  big_integer expected = 1;
+  big_integer expected_even = 1;
+  for (int e = 0; e < 300; ++e) {
+    EXPECT_EQ(pow_mod(a, e, m), expected);
+    EXPECT_EQ(pow_mod(a, e, 2 * m), expected_even);
+    expected = expected * a % m;
+    expected_even = expected_even * a % (2 * m);
+  }
+}
+
+TEST(correctness, montgomery_context) {
+  big_integer m = (big_integer(1) << 300) + 157;
+  montgomery_context ctx(m);
+  EXPECT_EQ(ctx.mod(), m);
+  big_integer a = (big_integer(1) << 299) + 42;
+  big_integer b = -(big_integer(1) << 500) - 7;
+  big_integer x = ctx.to_form(a);
+  big_integer y = ctx.to_form(b);
+  EXPECT_TRUE(x >= 0 && x < m);
+  EXPECT_EQ(ctx.from_form(x), a);
+  EXPECT_EQ(ctx.from_form(y), b % m + m);
+  EXPECT_EQ(ctx.from_form(ctx.mul(x, y)), a * (b % m + m) % m);
+  EXPECT_EQ(ctx.pow(a, big_integer(1) << 70), pow_mod(a, big_integer(1) << 70, m));
+}
+
+TEST(correctness, addmul_submul) {
+  big_integer a = (big_integer(1) << 200) + 12345;
+  big_integer b = (big_integer(1) << 150) - 1;
+  big_integer ab = a * b;
+  for (big_integer acc : {big_integer(0), big_integer(7), -big_integer(7), ab, -ab, ab << 2}) {
+    for (int sa : {1, -1}) {
+      for (int sb : {1, -1}) {
+        big_integer x = a * sa;
+        big_integer y = b * sb;
+        big_integer expected = acc + x * y;
+        big_integer r = acc;
+        EXPECT_EQ(addmul(r, x, y), expected);
+        r = acc;
+        EXPECT_EQ(submul(r, x, y), acc - x * y);
+        r = acc;
+        r += x * y;
+        EXPECT_EQ(r, expected);
+        r -= x * y;
+        EXPECT_EQ(r, acc);
+      }
+    }
+  }
+}
+
+TEST(correctness, addmul_long) {
+  for (int n : {100, 2000, 20000, 100000}) {
+    big_integer a = (big_integer(1) << n) - 1;
+    big_integer b = (big_integer(1) << (n / 2 + 3)) + 1;
+    big_integer acc = -(big_integer(1) << (n + n / 2 + 3));
+    big_integer expected = acc + a * b;
+    EXPECT_EQ(big_integer(acc) += a * b, expected);
+    EXPECT_EQ(big_integer(expected) -= a * b, acc);
+    EXPECT_EQ(big_integer(a * b), a * b);
+  }
+}
+
+TEST(correctness, addmul_aliasing) {
+  big_integer a = (big_integer(1) << 100) + 3;
+  big_integer b = 5;
+  big_integer expected = a + a * a;
+  addmul(a, a, a);
+  EXPECT_EQ(a, expected);
+  expected = b - b * 7;
+  submul(b, b, 7);
+  EXPECT_EQ(b, expected);
+  a = 10;
+  a += a * a;
+  EXPECT_EQ(a, 110);
+  a -= a * 2;
+  EXPECT_EQ(a, -110);
+}
+
+TEST(correctness, mul_lazy_product) {
+  big_integer a = (big_integer(1) << 100) + 1;
+  big_integer d = -(big_integer(1) << 90);
+  // temporary factors are moved into the product, it stays valid after the full expression
+  auto p = a * 3;
+  auto q = big_integer(-5) * (a + 1);
+  auto s = (a + 1) * (a - 1);
+  big_integer r = p;
+  EXPECT_EQ(r, a + a + a);
+  EXPECT_LT(q, 0);
+  EXPECT_EQ(s, a * a - 1);
+  EXPECT_EQ(big_integer(a * 2) >>= 1, a);
+  // b * c + d and its mirror images are accumulated in the other operand
+  big_integer expected = big_integer(a * a) + d;
+  EXPECT_EQ(a * a + d, expected);
+  EXPECT_EQ(d + a * a, expected);
+  EXPECT_EQ(a * a + big_integer(d), expected);
+  EXPECT_EQ(a * a - d, big_integer(a * a) - d);
+  EXPECT_EQ(d - a * a, -big_integer(a * a) + d);
+  EXPECT_EQ(a * a - a * a, 0);
+  EXPECT_EQ(-(a * 3), -r);
+  EXPECT_EQ(~(a * 3), ~r);
+  big_integer x = 5;
+  x = x * x + x;
+  EXPECT_EQ(x, 30);
+}
+
+TEST(correctness, mul_add_digit) {
+  big_integer a = (big_integer(1) << 100) - 1;
+  big_integer acc = -(big_integer(1) << 120);
+  big_integer expected = acc + a * 1000;
+  EXPECT_EQ(mul_add_digit(acc, a, 1000), expected);
+  EXPECT_EQ(mul_add_digit(acc, a, 0), expected);
+  EXPECT_EQ(mul_add_digit(acc, -a, 1000), -(big_integer(1) << 120));
+  EXPECT_EQ(mul_add_digit(acc, acc, 2), -3 * (big_integer(1) << 120));
+}
+
+namespace {
+class counting_resource : public std::pmr::memory_resource {
+public:
+  size_t allocations = 0;
+  size_t outstanding = 0;
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations;
+    outstanding += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    outstanding -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+} // namespace
+
+TEST(correctness, memory_scope) {
+  counting_resource resource;
+  big_integer a = (big_integer(1) << 5000) - 1;
+  big_integer d = (big_integer(1) << 3000) + 7;
+  big_integer expected = a * a / d;
+  big_integer outer;
+  big_integer grown = 1;
+  {
+    big_integer_memory_scope scope(&resource);
+    big_integer small = 12345;
+    EXPECT_EQ(resource.allocations, 0);
+    // numbers from before the scope keep operator new
+    outer = a * a / d;
+    grown <<= 100000;
+    EXPECT_GT(resource.allocations, 0);
+    {
+      big_integer_memory_scope inner(nullptr);
+      size_t before = resource.allocations;
+      EXPECT_EQ(a * a / d, expected);
+      EXPECT_EQ(resource.allocations, before);
+    }
+  }
+  EXPECT_EQ(resource.outstanding, 0);
+  EXPECT_EQ(outer, expected);
+  EXPECT_EQ(grown, big_integer(1) << 100000);
+
+  auto compute = [&] {
+    big_integer_memory_scope scope(&resource);
+    return a * a / d;
+  };
+  big_integer escaped = compute();
+  EXPECT_GT(resource.outstanding, 0);
+  EXPECT_EQ(escaped, expected);
+  // a number constructed in the scope grows on its resource after it
+  size_t after = resource.allocations;
+  escaped *= escaped;
+  EXPECT_GT(resource.allocations, after);
+  escaped = 0;
+  EXPECT_EQ(resource.outstanding, 0);
+}
+
+TEST(correctness, memory_scope_monotonic) {
+  big_integer expected = 1;
+  for (int i = 1; i <= 300; ++i) {
+    expected *= i;
+  }
+  std::pmr::monotonic_buffer_resource arena;
+  big_integer_memory_scope scope(&arena);
+  big_integer f = 1;
+  for (int i = 1; i <= 300; ++i) {
+    f *= i;
+  }
+  EXPECT_EQ(f, expected);
+  for (int i = 300; i > 1; --i) {
+    f /= i;
+  }
+  EXPECT_EQ(f, 1);
+}
+
+TEST(correctness, thread_pool) {
+  thread_pool pool(3);
+  std::vector<int> values(100000);
+  pool.parallel_for(0, values.size(), 1000, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      values[i] = static_cast<int>(i % 7);
+    }
+  });
+  long long sum = 0;
+  for (int v : values) {
+    sum += v;
+  }
+  EXPECT_EQ(sum, 299995);
+
+  int a = 0;
+  int b = 0;
+  int c = 0;
+  pool.invoke([&] { pool.invoke([&] { a = 1; }, [&] { b = 2; }); }, [&] { c = 3; });
+  EXPECT_EQ(a + b + c, 6);
+  EXPECT_THROW(pool.invoke([] {}, [] { throw std::runtime_error("task"); }), std::runtime_error);
+}
+
+TEST(correctness, parallel_scope) {
+  // just above the parallel thresholds of both digit sizes, so that every product and conversion forks once or twice
+  big_integer a = (big_integer(1) << 80000) / 3;
+  big_integer b = ((big_integer(1) << 70000) - 1) / 7;
+  big_integer c = (big_integer(1) << 66000) / 11;
+  big_integer ab = a * b;
+  big_integer aa = a * a;
+  big_integer bc = b * c;
+  std::string s = to_string(ab);
+  {
+    // a pool without workers runs everything on the caller
+    thread_pool pool(0);
+    big_integer_parallel_scope scope(&pool);
+    EXPECT_EQ(a * b, ab);
+  }
+  for (size_t threads : {1, 4}) {
+    thread_pool pool(threads);
+    big_integer_parallel_scope scope(&pool);
+    EXPECT_EQ(a * b, ab);
+    EXPECT_EQ(a * a, aa);
+    EXPECT_EQ(b * c, bc);
+    EXPECT_EQ(to_string(ab), s);
+    EXPECT_EQ(big_integer(s), ab);
+  }
+}
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(gcd(12, 18), 6);
+  EXPECT_EQ(gcd(-12, 18), 6);
+  EXPECT_EQ(gcd(12, -18), 6);
+  EXPECT_EQ(gcd(0, -5), 5);
+  EXPECT_EQ(gcd(7, 0), 7);
+  EXPECT_EQ(gcd(0, 0), 0);
+  EXPECT_EQ(gcd(17, 17), 17);
+  EXPECT_EQ(gcd(std::numeric_limits<long long>::min(), 6), 2);
+  EXPECT_EQ(gcd(big_integer("1000000000000000000000"), big_integer("250000000000000000000075")), 25);
+}
+
+TEST(correctness, gcd_long) {
+  big_integer g = (big_integer(1) << 5000) / 7 + 1;
+  big_integer a = (big_integer(1) << 30000) / 3;
+  EXPECT_EQ(gcd(a * g, (a + 1) * g), g);
+  EXPECT_EQ(gcd(a * g, g), g);
+  EXPECT_EQ(gcd(-g, a * g), g);
+  // consecutive Fibonacci numbers take the most steps of Euclid's algorithm
+  big_integer f0 = 0;
+  big_integer f1 = 1;
+  for (int i = 0; i < 20000; ++i) {
+    f0 += f1;
+    swap(f0, f1);
+  }
+  EXPECT_EQ(gcd(f1, f0), 1);
+  EXPECT_EQ(gcd(f1 * f0, f0 * (f0 + f1)), f0);
+}
+
+TEST(correctness, xgcd) {
+  big_integer f0 = 0;
+  big_integer f1 = 1;
+  for (int i = 0; i < 5000; ++i) {
+    f0 += f1;
+    swap(f0, f1);
+  }
+  big_integer l = (big_integer(1) << 9000) / 13;
+  std::vector<std::pair<big_integer, big_integer>> pairs{
+      {240, 46}, {-240, 46}, {240, -46},     {-240, -46}, {0, 0},           {0, -7}, {7, 0},
+      {1, 1},    {5, 5},     {f1, f0},       {f0, -f1},   {l * 3, l * 5},   {l, l + 1},
+      {l, -l},   {l * l + 1, l - 1}};
+  for (const auto& [a, b] : pairs) {
+    auto [g, x, y] = xgcd(a, b);
+    EXPECT_EQ(g, gcd(a, b));
+    EXPECT_EQ(a * x + b * y, g);
+  }
+}
+
+TEST(correctness, mod_inverse) {
+  EXPECT_EQ(mod_inverse(3, 11), 4);
+  EXPECT_EQ(mod_inverse(-3, 11), 7);
+  EXPECT_EQ(mod_inverse(3, -11), 4);
+  EXPECT_EQ(mod_inverse(14, 11), 4);
+  EXPECT_EQ(mod_inverse(6, 9), 0);
+  EXPECT_EQ(mod_inverse(0, 5), 0);
+  EXPECT_EQ(mod_inverse(5, 1), 0);
+  EXPECT_EQ(mod_inverse(1, 2), 1);
+  big_integer m = (big_integer(1) << 4423) - 1;
+  for (big_integer a : {big_integer(2), big_integer(3), m - 1, (big_integer(1) << 3000) + 12345, -m - 2}) {
+    big_integer inv = mod_inverse(a, m);
+    EXPECT_TRUE(inv >= 0 && inv < m);
+    EXPECT_EQ(a * inv % m, a > 0 ? 1 : 1 - m);
+  }
+  EXPECT_EQ(mod_inverse(m * 3, m * 5), 0);
+  EXPECT_EQ(mod_inverse(2, 1000000007), pow_mod(2, 1000000005, 1000000007));
+}
+
+TEST(correctness, isqrt) {
+  for (int i = 0; i < 1000; ++i) {
+    int r = 0;
+    while ((r + 1) * (r + 1) <= i) {
+      ++r;
+    }
+    EXPECT_EQ(isqrt(i), r);
+  }
+  EXPECT_EQ(isqrt(std::numeric_limits<unsigned long long>::max()), 4294967295u);
+  EXPECT_EQ(isqrt(big_integer("100000000000000000000000000000000000000")), big_integer("10000000000000000000"));
+  // about 10^5 bits with each top digit pattern of the root
+  for (big_integer r : {(big_integer(1) << 50000) - 1, (big_integer(1) << 50001) / 3, (big_integer(1) << 49999) + 7}) {
+    big_integer a = r * r;
+    EXPECT_EQ(isqrt(a), r);
+    EXPECT_EQ(isqrt(a - 1), r - 1);
+    EXPECT_EQ(isqrt(a + 2 * r), r);
+    EXPECT_EQ(isqrt(a + 2 * r + 1), r + 1);
+  }
+}
+
+TEST(correctness, iroot) {
+  EXPECT_EQ(iroot(0, 3), 0);
+  EXPECT_EQ(iroot(26, 3), 2);
+  EXPECT_EQ(iroot(27, 3), 3);
+  EXPECT_EQ(iroot(-27, 3), -3);
+  EXPECT_EQ(iroot(-28, 3), -3);
+  EXPECT_EQ(iroot(-26, 3), -2);
+  EXPECT_EQ(iroot(15, 2), 3);
+  EXPECT_EQ(iroot(-15, 1), -15);
+  EXPECT_EQ(iroot(1023, 10), 1);
+  EXPECT_EQ(iroot(1024, 10), 2);
+  EXPECT_EQ(iroot(std::numeric_limits<long long>::max(), 1000000), 1);
+  big_integer r = (big_integer(1) << 2000) / 7;
+  for (unsigned k : {3u, 4u, 5u, 17u}) {
+    big_integer a = 1;
+    for (unsigned i = 0; i < k; ++i) {
+      a *= r;
+    }
+    EXPECT_EQ(iroot(a, k), r);
+    EXPECT_EQ(iroot(a - 1, k), r - 1);
+    EXPECT_EQ(iroot(a + 1, k), r);
+  }
+}
+
+TEST(correctness, binary_round_trip) {
+  std::vector<big_integer> numbers{0,
+                                   -big_integer(0),
+                                   1,
+                                   -1,
+                                   std::numeric_limits<unsigned long long>::max(),
+                                   std::numeric_limits<long long>::min(),
+                                   big_integer("-123456789012345678901234567890"),
+                                   (big_integer(1) << 10000) / 3,
+                                   // read in several chunks
+                                   -((big_integer(1) << 10000000) - 1),
+                                   -(big_integer(1) << 96)};
+  std::stringstream s;
+  for (const auto& a : numbers) {
+    a.write_to(s);
+  }
+  big_integer b = 17;
+  for (const auto& a : numbers) {
+    b.read_from(s);
+    EXPECT_EQ(b, a);
+  }
+  EXPECT_EQ(s.peek(), EOF);
+}
+
+TEST(correctness, binary_format) {
+  std::stringstream s;
+  big_integer(-258).write_to(s);
+  EXPECT_EQ(s.str(), std::string("BI\1\1\1\0\0\0\2\1\0\0\0\0\0\0", 16));
+  s.str("");
+  big_integer(0).write_to(s);
+  EXPECT_EQ(s.str(), std::string("BI\1\0\0\0\0\0", 8));
+}
+
+TEST(correctness, binary_errors) {
+  big_integer a;
+  auto read = [&](const std::string& str) {
+    std::stringstream s(str);
+    a.read_from(s);
+  };
+  EXPECT_THROW(read(""), std::invalid_argument);
+  EXPECT_THROW(read(std::string("BJ\1\0\0\0\0\0", 8)), std::invalid_argument);
+  EXPECT_THROW(read(std::string("BI\2\0\0\0\0\0", 8)), std::invalid_argument);
+  EXPECT_THROW(read(std::string("BI\1\2\0\0\0\0", 8)), std::invalid_argument);
+  EXPECT_THROW(read(std::string("BI\1\0\1\0\0\0\1\0\0", 11)), std::invalid_argument);
+  EXPECT_THROW(read(std::string("BI\1\0\1\0\0\0\0\0\0\0\0\0\0\0", 16)), std::invalid_argument);
+  EXPECT_EQ(a, 0);
+  // a corrupt length with no payload must not allocate its 32 GiB up front
+  try {
+    read(std::string("BI\1\0\377\377\377\377", 8));
+    ADD_FAILURE() << "no exception for a truncated record";
+  } catch (const std::invalid_argument& e) {
+    EXPECT_EQ(std::string(e.what()).rfind("truncated", 0), 0);
+  }
+  read(std::string("BI\1\0\1\0\0\0\0\0\0\0\0\0\0\1", 16));
+  EXPECT_EQ(a, big_integer(1) << 56);
+}
+
+TEST(correctness, binary_view) {
+  std::vector<big_integer> numbers{5, -(big_integer(1) << 5000) / 7, 0, big_integer("-4294967296")};
+  std::stringstream s;
+  for (const auto& a : numbers) {
+    a.write_to(s);
+  }
+  std::string str = s.str();
+  // a buffer aligned like a mapped file
+  std::vector<uint64_t> buffer(str.size() / 8);
+  std::memcpy(buffer.data(), str.data(), str.size());
+  const char* p = reinterpret_cast<const char*>(buffer.data());
+  size_t left = str.size();
+  for (const auto& a : numbers) {
+    big_integer_view v(p, left);
+    EXPECT_TRUE(v == a);
+    EXPECT_EQ(big_integer(v), a);
+    EXPECT_EQ(v.is_negative(), a < 0);
+    p += v.record_size();
+    left -= v.record_size();
+  }
+  EXPECT_EQ(left, 0);
+  EXPECT_FALSE(big_integer_view(buffer.data(), str.size()) == 6);
+  EXPECT_THROW(big_integer_view(buffer.data(), 15), std::invalid_argument);
+}
+
+TEST(correctness, radix_to_string) {
+  EXPECT_EQ(to_string(0, 16), "0");
+  EXPECT_EQ(to_string(255, 16), "ff");
+  EXPECT_EQ(to_string(-255, 2), "-11111111");
+  EXPECT_EQ(to_string(64, 8), "100");
+  EXPECT_EQ(to_string(1000, 32), "v8");
+  EXPECT_EQ(to_string(1000, 4), "33220");
+  EXPECT_EQ(to_string(-1000, 10), "-1000");
+  EXPECT_EQ(to_string(std::numeric_limits<unsigned long long>::max(), 16), "ffffffffffffffff");
+  EXPECT_EQ(to_string(big_integer(1) << 64, 16), "1" + std::string(16, '0'));
+  EXPECT_EQ(to_string(big_integer(1) << 65, 8), "4" + std::string(21, '0'));
+  EXPECT_EQ(to_string(big_integer("81985529216486895") << 128, 16), "123456789abcdef" + std::string(32, '0'));
+  EXPECT_THROW(to_string(5, 3), std::invalid_argument);
+  EXPECT_THROW(to_string(5, 64), std::invalid_argument);
+}
+
+TEST(correctness, radix_from_string) {
+  EXPECT_EQ(big_integer("ff", 16), 255);
+  EXPECT_EQ(big_integer("-FF", 16), -255);
+  EXPECT_EQ(big_integer("+777", 8), 511);
+  EXPECT_EQ(big_integer("vV", 32), 1023);
+  EXPECT_EQ(big_integer("000101", 2), 5);
+  EXPECT_EQ(big_integer("-1000", 10), -1000);
+  EXPECT_EQ(big_integer("123456789AbCdEf0123456789aBcDeF", 16), big_integer("1512366075204170929049582354406559215"));
+  big_integer a = (big_integer(1) << 1000) / 7;
+  for (int base : {2, 4, 8, 16, 32}) {
+    EXPECT_EQ(big_integer(to_string(a, base), base), a);
+    EXPECT_EQ(big_integer(to_string(-a, base), base), -a);
+  }
+  EXPECT_THROW(big_integer("12", 16 + 1), std::invalid_argument);
+  EXPECT_THROW(big_integer("", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("-", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("12", 2), std::invalid_argument);
+  EXPECT_THROW(big_integer("8", 8), std::invalid_argument);
+  EXPECT_THROW(big_integer("w", 32), std::invalid_argument);
+  EXPECT_THROW(big_integer("1 2", 16), std::invalid_argument);
+  // a bad character inside a whole 16-character chunk
+  EXPECT_THROW(big_integer("123456789abcdefg", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("0123456789abcdef:123456789abcdef", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("0123456789abcdef-0123456789abcdef", 16), std::invalid_argument);
+}
+
+TEST(correctness, divisor) {
+  using digit = big_integer::digit;
+  big_integer a = (big_integer(1) << 3000) / 7 + 12345;
+  std::vector<digit> values{1, 2, 3, 7, 10, 1000000000, 65536, std::numeric_limits<digit>::max(),
+                            std::numeric_limits<digit>::max() / 2 + 1, std::numeric_limits<digit>::max() / 3};
+  for (digit v : values) {
+    divisor d(v);
+    EXPECT_EQ(d.value(), v);
+    for (const big_integer& x : {a, -a, big_integer(0), big_integer(v - 1), big_integer(v), -(a >> 2900)}) {
+      big_integer q = x / d;
+      big_integer r = x % d;
+      EXPECT_EQ(q * big_integer(v) + r, x);
+      EXPECT_TRUE(r < big_integer(v) && -r < big_integer(v));
+      EXPECT_TRUE(r == 0 || (r < 0) == (x < 0));
+      EXPECT_EQ(q, x / big_integer(v));
+      EXPECT_EQ(r, x % big_integer(v));
+    }
+  }
+  big_integer b = a;
+  b /= divisor(1000000000);
+  EXPECT_EQ(b, a / 1000000000);
+  b %= divisor(1000);
+  EXPECT_EQ(b, a / 1000000000 % 1000);
+}
+
+TEST(correctness, factorial) {
+  big_integer f = 1;
+  for (unsigned n = 0; n <= 3000; ++n) {
+    if (n > 0) {
+      f *= n;
+    }
+    if (n < 100 || n % 97 == 0 || n == 3000) {
+      EXPECT_EQ(factorial(n), f);
+    }
+  }
+  EXPECT_EQ(factorial(20), 2432902008176640000ull);
+}
+
+TEST(correctness, binomial) {
+  std::vector<big_integer> row{1};
+  for (unsigned n = 1; n <= 300; ++n) {
+    std::vector<big_integer> next(n + 1, 1);
+    for (unsigned k = 1; k < n; ++k) {
+      next[k] = row[k - 1] + row[k];
+    }
+    row = std::move(next);
+    for (unsigned k = 0; k <= n; k += (n < 50 ? 1 : 7)) {
+      EXPECT_EQ(binomial(n, k), row[k]);
+    }
+  }
+  EXPECT_EQ(binomial(5, 6), 0);
+  EXPECT_EQ(binomial(0, 0), 1);
+  EXPECT_EQ(binomial(10000, 5000) * factorial(5000) * factorial(5000), factorial(10000));
+}
+
+TEST(correctness, primorial) {
+  EXPECT_EQ(primorial(0), 1);
+  EXPECT_EQ(primorial(1), 1);
+  EXPECT_EQ(primorial(2), 2);
+  EXPECT_EQ(primorial(10), 210);
+  EXPECT_EQ(primorial(30), 6469693230ull);
+  big_integer p = primorial(10000);
+  EXPECT_EQ(gcd(p, factorial(10000)), p);
+  EXPECT_EQ(p % 9973, 0);
+  EXPECT_NE(p % 9409, 0);
+}
+
+TEST(correctness, factorial_parallel) {
+  big_integer f = factorial(30000);
+  thread_pool pool(3);
+  big_integer_parallel_scope scope(&pool);
+  EXPECT_EQ(factorial(30000), f);
+  EXPECT_EQ(binomial(30000, 12345) * factorial(12345) * factorial(30000 - 12345), f);
+}
+
+TEST(correctness, fixed_constexpr) {
+  using u256 = fixed_big_integer<256>;
+  constexpr u256 max = ~u256();
+  static_assert(max + 1 == 0);
+  static_assert(u256() - 1 == max);
+  static_assert(max * max == 1);
+  static_assert((u256(1) << 255) * 2 == 0);
+  static_assert(((u256(1) << 200) >> 199) == 2);
+  static_assert((u256(1) << 64) - 1 == u256(~0ull));
+  static_assert(u256(std::numeric_limits<uint64_t>::max()) * u256(std::numeric_limits<uint64_t>::max()) ==
+                u256({1, std::numeric_limits<uint64_t>::max() - 1, 0, 0}));
+  static_assert(u256(5) < u256(7) && max > (u256(1) << 255) && u256(3) <= u256(3));
+  static_assert((max << 256) == 0 && (max >> 300) == 0);
+  static_assert(-u256(1) == max);
+}
+
+TEST(correctness, fixed_conversion) {
+  big_integer a = (big_integer(1) << 300) / 7;
+  EXPECT_EQ(big_integer(fixed_big_integer<512>(a)), a);
+  EXPECT_EQ(big_integer(fixed_big_integer<256>(a)), a % (big_integer(1) << 256));
+  EXPECT_EQ(big_integer(fixed_big_integer<512>(-a)), (big_integer(1) << 512) - a);
+  EXPECT_EQ(big_integer(fixed_big_integer<64>(big_integer(-1))), std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(big_integer(fixed_big_integer<4096>()), 0);
+  EXPECT_EQ(fixed_big_integer<128>(big_integer(123)), 123);
+}
+
+TEST(correctness, fixed_arithmetic) {
+  constexpr size_t BITS = 512;
+  big_integer mod = big_integer(1) << BITS;
+  auto wrap = [&](const big_integer& x) { return fixed_big_integer<BITS>(x); };
+  std::vector<big_integer> values{0, 1, 2, mod - 1, mod / 2, mod / 2 - 1, (big_integer(1) << 64) - 1,
+                                  big_integer(1) << 64, (big_integer(1) << 448) + 12345};
+  big_integer x = 1;
+  for (int i = 0; i < 30; ++i) {
+    x = (x * 6364136223846793005ull + 1442695040888963407ull) % mod;
+    values.push_back(x >> (i * 17 % BITS));
+  }
+  for (const big_integer& a : values) {
+    for (const big_integer& b : values) {
+      fixed_big_integer<BITS> fa = wrap(a);
+      fixed_big_integer<BITS> fb = wrap(b);
+      EXPECT_EQ(big_integer(fa + fb), (a + b) % mod);
+      EXPECT_EQ(big_integer(fa - fb), (a - b + mod) % mod);
+      EXPECT_EQ(big_integer(fa * fb), a * b % mod);
+      EXPECT_EQ(big_integer(fa & fb), a & b);
+      EXPECT_EQ(big_integer(fa | fb), a | b);
+      EXPECT_EQ(big_integer(fa ^ fb), a ^ b);
+      EXPECT_EQ(fa < fb, a < b);
+      EXPECT_EQ(fa == fb, a == b);
+      EXPECT_EQ(fa > fb, a > b);
+    }
+    for (size_t shift : {0, 1, 63, 64, 65, 200, 511}) {
+      EXPECT_EQ(big_integer(wrap(a) << shift), (a << shift) % mod);
+      EXPECT_EQ(big_integer(wrap(a) >> shift), a >> shift);
+    }
+  }
+}
+
+#ifdef BIGINT_INSTRUMENTATION
+TEST(correctness, statistics) {
+  using statistics = big_integer_statistics;
+  size_t digits = 1024 / (8 * sizeof(big_integer::digit)) + 1;
+  big_integer a = big_integer(1) << 1024;
+  reset_big_integer_statistics();
+
+  big_integer b = a * a;
+  b -= a;
+  b += 1;
+  big_integer c = a;
+  c -= a;
+  std::string s = to_string(b);
+  EXPECT_EQ(big_integer(s), b);
+
+  statistics snapshot = big_integer_statistics_snapshot();
+  const statistics::counters& mul = snapshot.operations[statistics::MUL];
+  EXPECT_EQ(mul.calls, 1);
+  EXPECT_EQ(mul.lhs_sizes[std::bit_width(digits)], 1);
+  EXPECT_EQ(mul.rhs_sizes[std::bit_width(digits)], 1);
+  EXPECT_GE(mul.allocations, 1);
+  // the additions inside the subtractions and the conversions are not counted
+  EXPECT_EQ(snapshot.operations[statistics::ADD].calls, 1);
+  EXPECT_EQ(snapshot.operations[statistics::SUB].calls, 2);
+  EXPECT_GE(snapshot.operations[statistics::SUB].shrinks, 1);
+  EXPECT_EQ(snapshot.operations[statistics::TO_STRING].calls, 1);
+  EXPECT_EQ(snapshot.operations[statistics::FROM_STRING].calls, 1);
+  EXPECT_EQ(snapshot.operations[statistics::DIV].calls, 0);
+  EXPECT_EQ(snapshot.operations[statistics::SHL].calls, 0);
+  EXPECT_GT(snapshot.operations[statistics::TO_STRING].nanoseconds, 0);
+  EXPECT_STREQ(statistics::NAMES[statistics::FROM_STRING], "from_string");
+
+  reset_big_integer_statistics();
+  EXPECT_EQ(big_integer_statistics_snapshot().operations[statistics::MUL].calls, 0);
+}
+#endif
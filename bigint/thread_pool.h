@@ -0,0 +1,233 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Fork-join pool of worker threads. A worker pushes the tasks it spawns to its own deque and takes them
+// back from the same end, idle workers steal from the opposite end of the others' deques. A thread that
+// waits for its tasks runs other queued tasks meanwhile, so nested invoke never blocks a worker.
+class thread_pool {
+public:
+  explicit thread_pool(size_t threads = std::thread::hardware_concurrency()) : _queues(threads + 1) {
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      _threads.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard lock(_sleep_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& thread : _threads) {
+      thread.join();
+    }
+  }
+
+  size_t size() const noexcept {
+    return _threads.size();
+  }
+
+  // runs all functions, possibly in parallel, and returns when every one of them is done;
+  // the first exception thrown by them is rethrown afterwards
+  template <typename F, typename... Fs>
+  void invoke(F&& first, Fs&&... rest) {
+    std::tuple<callable_task<std::remove_reference_t<Fs>>...> tasks(rest...);
+    // if a push throws, first is skipped and the tasks pushed so far are joined, the deques point into tasks
+    size_t pushed = 0;
+    std::exception_ptr error;
+    try {
+      std::apply([this, &pushed](auto&... t) { ((push(t), ++pushed), ...); }, tasks);
+      first();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // joined in the reverse order, so that tasks nobody stole are taken back from the top of the deque
+    if constexpr (sizeof...(Fs) > 0) {
+      std::apply(
+          [this, &error, pushed](auto&... t) {
+            task* spawned[]{&t...};
+            for (size_t i = pushed; i-- > 0;) {
+              join(*spawned[i]);
+              if (!error) {
+                error = spawned[i]->error;
+              }
+            }
+          },
+          tasks);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // calls f(lo, hi) for pieces of [first, last) no longer than grain, possibly in parallel
+  template <typename F>
+  void parallel_for(size_t first, size_t last, size_t grain, const F& f) {
+    if (last - first <= grain) {
+      f(first, last);
+      return;
+    }
+    size_t mid = first + (last - first) / 2;
+    invoke([&] { parallel_for(first, mid, grain, f); }, [&] { parallel_for(mid, last, grain, f); });
+  }
+
+private:
+  struct task {
+    virtual void run() noexcept = 0;
+
+    std::atomic<bool> done = false;
+    std::exception_ptr error;
+  };
+
+  template <typename F>
+  struct callable_task final : task {
+    explicit callable_task(F& f) : f(f) {}
+
+    void run() noexcept override {
+      try {
+        f();
+      } catch (...) {
+        this->error = std::current_exception();
+      }
+      this->done.store(true, std::memory_order_release);
+    }
+
+    F& f;
+  };
+
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<task*> tasks;
+  };
+
+  // outside threads share the last queue
+  size_t own_queue() const noexcept {
+    return _current_pool == this ? _current_index : _queues.size() - 1;
+  }
+
+  // counted before it is published, so that a thief's decrement never runs ahead of the increment
+  void push(task& t) {
+    task_queue& queue = _queues[own_queue()];
+    {
+      std::lock_guard lock(_sleep_mutex);
+      ++_pending;
+    }
+    try {
+      std::lock_guard lock(queue.mutex);
+      queue.tasks.push_back(&t);
+    } catch (...) {
+      --_pending;
+      throw;
+    }
+    _wake.notify_one();
+  }
+
+  // t may be gone once run returns, the waiters in join only look at their own tasks
+  void execute(task& t) {
+    t.run();
+    {
+      std::lock_guard lock(_done_mutex);
+    }
+    _done.notify_all();
+  }
+
+  // runs t right away if nobody took it yet, otherwise helps with other tasks until it is done
+  void join(task& t) {
+    task_queue& queue = _queues[own_queue()];
+    {
+      std::unique_lock lock(queue.mutex);
+      for (auto it = queue.tasks.rbegin(); it != queue.tasks.rend(); ++it) {
+        if (*it == &t) {
+          queue.tasks.erase(std::next(it).base());
+          --_pending;
+          lock.unlock();
+          t.run();
+          return;
+        }
+      }
+    }
+    // a thief runs t, help with other tasks meanwhile and sleep once there were none for a while
+    for (size_t idle = 0; !t.done.load(std::memory_order_acquire);) {
+      if (task* other = take_task()) {
+        execute(*other);
+        idle = 0;
+      } else if (++idle < JOIN_SPINS) {
+        std::this_thread::yield();
+      } else {
+        std::unique_lock lock(_done_mutex);
+        _done.wait(lock, [&t] { return t.done.load(std::memory_order_acquire); });
+      }
+    }
+  }
+
+  // the newest task of the own queue, or the oldest one of the shared queue or of another worker
+  task* take_task() {
+    size_t own = own_queue();
+    for (size_t i = 0; i < _queues.size(); ++i) {
+      size_t index = (own + i) % _queues.size();
+      task_queue& queue = _queues[index];
+      std::lock_guard lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task* t;
+        if (i == 0) {
+          t = queue.tasks.back();
+          queue.tasks.pop_back();
+        } else {
+          t = queue.tasks.front();
+          queue.tasks.pop_front();
+        }
+        --_pending;
+        return t;
+      }
+    }
+    return nullptr;
+  }
+
+  void work(size_t index) {
+    _current_pool = this;
+    _current_index = index;
+    while (true) {
+      if (task* t = take_task()) {
+        execute(*t);
+        continue;
+      }
+      std::unique_lock lock(_sleep_mutex);
+      _wake.wait(lock, [this] { return _stop || _pending > 0; });
+      if (_stop) {
+        return;
+      }
+    }
+  }
+
+private:
+  // rounds of join without a task to help with before it sleeps
+  static constexpr size_t JOIN_SPINS = 64;
+
+  static inline thread_local const thread_pool* _current_pool = nullptr;
+  static inline thread_local size_t _current_index = 0;
+
+  std::vector<std::thread> _threads;
+  std::vector<task_queue> _queues;
+
+  std::mutex _sleep_mutex;
+  std::condition_variable _wake;
+  std::atomic<size_t> _pending = 0;
+  bool _stop = false;
+
+  std::mutex _done_mutex;
+  std::condition_variable _done;
+};
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <istream>
+#include <string_view>
 
 namespace huffman::impl {
 class buffered_reader {
@@ -34,6 +35,18 @@ public:
     return tmp;
   }
 
+  // the bytes of the buffer that are not read yet, the next ones if there are none
+  std::string_view buffered() {
+    if (current == readed) {
+      next_buffer();
+    }
+    return {buffer.data() + current, readed - current};
+  }
+
+  void skip(size_t count) noexcept {
+    current += count;
+  }
+
   operator bool() noexcept {
     return !error() && !eof();
   }
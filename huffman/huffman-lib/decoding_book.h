@@ -41,10 +41,14 @@ public:
   };
 };
 
+class decoding_table;
+
 class decoding_book {
 private:
   std::unique_ptr<node> root = nullptr;
 
+  friend decoding_table;
+
   class iterator {
   private:
     const node* root;
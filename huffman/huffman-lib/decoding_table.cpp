@@ -0,0 +1,77 @@
+#include "decoding_table.h"
+
+#include <algorithm>
+
+// a single leaf in the root has the code 0
+static const huffman::impl::node* descend(const huffman::impl::node* current, bool bit) noexcept {
+  if (current->is_leaf()) {
+    return bit ? nullptr : current;
+  }
+  auto* current_p = static_cast<const huffman::impl::parent*>(current);
+  return bit ? current_p->child_1.get() : current_p->child_0.get();
+}
+
+static size_t depth(const huffman::impl::node* current) noexcept {
+  if (current->is_leaf()) {
+    return 0;
+  }
+  auto* current_p = static_cast<const huffman::impl::parent*>(current);
+  return 1 + std::max(depth(current_p->child_0.get()), depth(current_p->child_1.get()));
+}
+
+struct walk_result {
+  // a leaf, the node the bits end in, or nullptr if no code starts with them
+  const huffman::impl::node* end;
+  size_t bits;
+};
+
+// follows the bits of index from the highest of width ones, starting with the skip-th, until a leaf
+static walk_result walk(const huffman::impl::node* from, size_t index, size_t width, size_t skip) noexcept {
+  const huffman::impl::node* current = from;
+  for (size_t i = skip; i < width; ++i) {
+    current = descend(current, (index >> (width - i - 1)) & 1u);
+    if (!current || current->is_leaf()) {
+      return {current, i + 1 - skip};
+    }
+  }
+  return {current, width - skip};
+}
+
+size_t huffman::impl::decoding_table::build(const node* root, const node* from, size_t width) {
+  size_t offset = table.size();
+  table.resize(offset + (1ull << width));
+  for (size_t index = 0; index < (1ull << width); ++index) {
+    entry e;
+    walk_result first = walk(from, index, width, 0);
+    if (!first.end) {
+      continue;
+    }
+    if (!first.end->is_leaf()) {
+      size_t link_bits = std::min(depth(first.end), TABLE_BITS);
+      e.first_bits = e.bits = width;
+      e.link_bits = link_bits;
+      e.link = build(root, first.end, link_bits);
+      table[offset + index] = e;
+      continue;
+    }
+    e.first_bits = e.bits = first.bits;
+    e.symbols[e.count++] = static_cast<const leaf*>(first.end)->data;
+    // the codes that follow in the rest of the bits
+    while (e.count < MAX_SYMBOLS && e.bits < width) {
+      walk_result next = walk(root, index, width, e.bits);
+      if (!next.end || !next.end->is_leaf()) {
+        break;
+      }
+      e.bits += next.bits;
+      e.symbols[e.count++] = static_cast<const leaf*>(next.end)->data;
+    }
+    table[offset + index] = e;
+  }
+  return offset;
+}
+
+huffman::impl::decoding_table::decoding_table(const decoding_book& dec_book) : decoding_table() {
+  if (dec_book.root) {
+    build(dec_book.root.get(), dec_book.root.get(), TABLE_BITS);
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "constants.h"
+#include "decoding_book.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace huffman::impl {
+// Lookup tables for decoding many bits at once. The main table is indexed by the next TABLE_BITS bits of the
+// data, its entries hold up to MAX_SYMBOLS symbols whose codes end within those bits. An entry of a prefix of
+// longer codes links to a table indexed by the bits that follow the prefix, and so on down the tree.
+class decoding_table {
+public:
+  static constexpr size_t TABLE_BITS = 11;
+  static constexpr size_t MAX_SYMBOLS = 4;
+
+  struct entry {
+    std::array<encoding_type, MAX_SYMBOLS> symbols{};
+    // zero for links and for bits that no code starts with
+    uint8_t count = 0;
+    // bits taken by the first symbol and by all of them, or by the prefix of a link
+    uint8_t first_bits = 0;
+    uint8_t bits = 0;
+    // the table of a link has 2^link_bits entries starting at link, zero if there is no link
+    uint8_t link_bits = 0;
+    uint32_t link = 0;
+  };
+
+private:
+  std::vector<entry> table;
+
+  size_t build(const node* root, const node* from, size_t width);
+
+public:
+  decoding_table() noexcept = default;
+  explicit decoding_table(const decoding_book& dec_book);
+
+  bool empty() const noexcept {
+    return table.empty();
+  }
+
+  // the entry of the main table for the next TABLE_BITS bits
+  const entry& operator[](size_t index) const noexcept {
+    return table[index];
+  }
+
+  // the entry of the table e links to for the next e.link_bits bits
+  const entry& follow(const entry& e, size_t index) const noexcept {
+    return table[e.link + index];
+  }
+};
+} // namespace huffman::impl
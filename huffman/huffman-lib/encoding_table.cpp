@@ -0,0 +1,19 @@
+#include "encoding_table.h"
+
+#include <stdexcept>
+#include <string>
+
+huffman::impl::encoding_table::encoding_table(const encoding_book& enc_book) : encoding_table() {
+  for (size_t i = 0; i < ENCODING_VALUE_COUNT; ++i) {
+    const auto& seq = enc_book[i];
+    if (seq.size() > MAX_CODE_SIZE) {
+      throw std::runtime_error("the data is too large to encode: its codes are longer than " +
+                               std::to_string(MAX_CODE_SIZE) + " bits");
+    }
+    const auto& raw = seq.raw_data();
+    for (size_t j = 0; j < raw.size(); ++j) {
+      table[i].code |= static_cast<uint64_t>(raw[j]) << (64 - (j + 1) * bit_sequence::RAW_SIZE);
+    }
+    table[i].len = seq.size();
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "constants.h"
+#include "encoding_book.h"
+
+#include <array>
+#include <cstdint>
+
+namespace huffman::impl {
+// The codes of an encoding book in machine words for the encoder. The encoder writes out whole bytes after every
+// code, so a code and up to 7 bits waiting before it have to fit into a word.
+class encoding_table {
+public:
+  static constexpr size_t MAX_CODE_SIZE = 56;
+
+  struct entry {
+    // the code in the highest len bits, zeros below
+    uint64_t code = 0;
+    uint8_t len = 0;
+  };
+
+private:
+  std::array<entry, ENCODING_VALUE_COUNT> table{};
+
+public:
+  encoding_table() noexcept = default;
+  explicit encoding_table(const encoding_book& enc_book);
+
+  const entry& operator[](encoding_type value) const noexcept {
+    return table[value];
+  }
+};
+} // namespace huffman::impl
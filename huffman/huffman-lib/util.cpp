@@ -1,18 +1,23 @@
 #include "util.h"
 
 #include "buffered_reader.h"
+#include "decoding_table.h"
+#include "encoding_table.h"
 
 #include <array>
 #include <cstring>
 #include <iostream>
 
-static const size_t SEQ_SIZE = 1024ull * CHAR_BIT;
+static const size_t OUT_SIZE = 1024ull;
 
 huffman::impl::histogram huffman::impl::calc_histogram(buffered_reader& reader) {
   histogram res;
   res.fill(0);
-  while (reader) {
-    ++res[static_cast<unsigned char>(reader.read())];
+  for (std::string_view chunk = reader.buffered(); !chunk.empty(); chunk = reader.buffered()) {
+    for (char c : chunk) {
+      ++res[static_cast<unsigned char>(c)];
+    }
+    reader.skip(chunk.size());
   }
   if (reader) {
     throw std::runtime_error("unexpected error while reading data: " + std::string(std::strerror(errno)));
@@ -21,13 +26,6 @@ huffman::impl::histogram huffman::impl::calc_histogram(buffered_reader& reader)
   return res;
 }
 
-static void flush(huffman::impl::bit_sequence& seq, std::ostream& to) {
-  if (seq.size()) {
-    to.write(reinterpret_cast<const char*>(seq.raw_data().data()), seq.size() / huffman::impl::bit_sequence::RAW_SIZE);
-    seq.cut_to_tail();
-  }
-}
-
 static size_t get_encoded_size(const huffman::impl::histogram& hist, const huffman::impl::encoding_book& enc_book) {
   size_t encoded_size = 0;
   for (size_t i = 0; i < huffman::impl::ENCODING_VALUE_COUNT; ++i) {
@@ -37,27 +35,47 @@ static size_t get_encoded_size(const huffman::impl::histogram& hist, const huffm
 }
 
 static void encode_data(huffman::impl::buffered_reader& reader, std::ostream& to,
-                        const huffman::impl::encoding_book& enc_book) {
-  huffman::impl::bit_sequence seq;
-  while (reader) {
-    seq |= enc_book[static_cast<unsigned char>(reader.read())];
-    if (seq.size() >= SEQ_SIZE) {
-      flush(seq, to);
+                        const huffman::impl::encoding_table& enc_table) {
+  static const size_t WORD_SIZE = 64;
+  // room for a word written past OUT_SIZE
+  std::array<char, OUT_SIZE + sizeof(uint64_t)> out;
+  size_t out_size = 0;
+  // less than a byte of bits is left here after every code
+  uint64_t bits = 0;
+  size_t count = 0;
+  for (std::string_view chunk = reader.buffered(); !chunk.empty(); chunk = reader.buffered()) {
+    for (char c : chunk) {
+      const auto& e = enc_table[static_cast<unsigned char>(c)];
+      bits |= e.code >> count;
+      count += e.len;
+      // the whole word, but only the complete bytes count
+      for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        out[out_size + i] = static_cast<char>(bits >> (WORD_SIZE - CHAR_BIT * (i + 1)));
+      }
+      out_size += count / CHAR_BIT;
+      bits <<= count / CHAR_BIT * CHAR_BIT;
+      count %= CHAR_BIT;
+      if (out_size >= OUT_SIZE) {
+        to.write(out.data(), out_size);
+        out_size = 0;
+      }
     }
+    reader.skip(chunk.size());
   }
-  flush(seq, to);
-  if (!seq.empty()) {
-    to.put(static_cast<char>(seq.raw_data().back()));
+  if (count) {
+    out[out_size++] = static_cast<char>(bits >> (WORD_SIZE - CHAR_BIT));
   }
+  to.write(out.data(), out_size);
 }
 
 void huffman::encode(std::istream& from, std::ostream& to) {
   impl::buffered_reader reader(from);
   auto hist = impl::calc_histogram(reader);
   auto enc_book = impl::build_encoding_book(hist);
+  impl::encoding_table enc_table(enc_book);
   serialize(enc_book, to);
   to.put(static_cast<char>((get_encoded_size(hist, enc_book) - 1u) % CHAR_BIT));
-  encode_data(reader, to, enc_book);
+  encode_data(reader, to, enc_table);
   if (reader.error()) {
     throw std::runtime_error("unexpected error while reading data");
   }
@@ -66,36 +84,125 @@ void huffman::encode(std::istream& from, std::ostream& to) {
   }
 }
 
-static void decode_data(huffman::impl::buffered_reader& reader, std::ostream& to,
-                        huffman::impl::decoding_book& dec_book, unsigned char last_size) {
-  auto iter = dec_book.iter();
-  while (reader) {
-    huffman::impl::bit_sequence seq = reader.read();
-    reader.get();
-    size_t bound = reader ? seq.size() : last_size;
-    for (size_t i = 0; i < bound; ++i) {
-      auto res = iter(seq[i]);
-      if (res.has_value()) {
-        to.put(static_cast<char>(res.value()));
+namespace {
+// the data MSB-first in the highest bits of a 64-bit word, refilled a word at a time from the buffer of the reader
+// up to its last few bytes
+class bit_buffer {
+private:
+  static const size_t WORD_SIZE = 64;
+
+  huffman::impl::buffered_reader& reader;
+  unsigned char last_size;
+  uint64_t bits = 0;
+  size_t count = 0;
+  // the part of the buffer of the reader taken from it and how far it is read
+  const char* begin = nullptr;
+  const char* current = nullptr;
+  const char* end = nullptr;
+
+public:
+  bit_buffer(huffman::impl::buffered_reader& reader, unsigned char last_size) noexcept
+      : reader(reader),
+        last_size(last_size) {}
+
+  void refill() {
+    if (end - current > static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+      // none of the bytes is the last one, the bits past count are the same ones the next refill puts there
+      uint64_t word = 0;
+      for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        word = word << CHAR_BIT | static_cast<unsigned char>(current[i]);
       }
+      bits |= word >> count;
+      current += (WORD_SIZE - 1 - count) / CHAR_BIT;
+      count |= WORD_SIZE - CHAR_BIT;
+      return;
     }
+    reader.skip(current - begin);
+    while (count <= WORD_SIZE - CHAR_BIT && reader) {
+      auto byte = static_cast<unsigned char>(reader.read());
+      size_t size = reader ? CHAR_BIT : last_size;
+      byte &= 0xffu << (CHAR_BIT - size);
+      bits |= static_cast<uint64_t>(byte) << (WORD_SIZE - CHAR_BIT - count);
+      count += size;
+    }
+    std::string_view chunk = reader.buffered();
+    begin = current = chunk.data();
+    end = chunk.data() + chunk.size();
+  }
+
+  size_t size() const noexcept {
+    return count;
   }
-  if (!iter.in_root()) {
-    throw std::invalid_argument("incorrect data format: the data has undecodable tail");
+
+  // the next n bits, 0 < n <= 32, zeros past the end of the data
+  size_t peek(size_t n) const noexcept {
+    return bits >> (WORD_SIZE - n);
+  }
+
+  void skip(size_t n) noexcept {
+    bits <<= n;
+    count -= n;
+  }
+};
+} // namespace
+
+static void decode_data(huffman::impl::buffered_reader& reader, std::ostream& to,
+                        const huffman::impl::decoding_table& dec_table, unsigned char last_size) {
+  using huffman::impl::decoding_table;
+  bit_buffer buffer(reader, last_size);
+  buffer.refill();
+  if (buffer.size() && dec_table.empty()) {
+    throw std::invalid_argument("incorrect data format: the data has empty encoding book, but it is not empty itself");
+  }
+  std::array<char, OUT_SIZE> out;
+  size_t out_size = 0;
+  while (buffer.size()) {
+    const decoding_table::entry* e = &dec_table[buffer.peek(decoding_table::TABLE_BITS)];
+    while (e->count == 0) {
+      if (!e->link_bits) {
+        throw std::invalid_argument("incorrect data format: the encoding book contains a single character. "
+                                    "only 0 are expected in encoded data");
+      }
+      if (e->bits > buffer.size()) {
+        throw std::invalid_argument("incorrect data format: the data has undecodable tail");
+      }
+      buffer.skip(e->bits);
+      buffer.refill();
+      e = &dec_table.follow(*e, buffer.peek(e->link_bits));
+    }
+    if (out_size + decoding_table::MAX_SYMBOLS > OUT_SIZE) {
+      to.write(out.data(), out_size);
+      out_size = 0;
+    }
+    if (e->bits <= buffer.size()) {
+      // all the symbols, the ones past count are overwritten later
+      std::memcpy(out.data() + out_size, e->symbols.data(), decoding_table::MAX_SYMBOLS);
+      out_size += e->count;
+      buffer.skip(e->bits);
+    } else if (e->first_bits <= buffer.size()) {
+      // only the end of the data is too short for all the codes of an entry
+      out[out_size++] = static_cast<char>(e->symbols[0]);
+      buffer.skip(e->first_bits);
+    } else {
+      throw std::invalid_argument("incorrect data format: the data has undecodable tail");
+    }
+    buffer.refill();
   }
+  to.write(out.data(), out_size);
   to.flush();
 }
 
 void huffman::decode(std::istream& from, std::ostream& to) {
   auto enc_book = impl::deserialize(from);
   impl::decoding_book dec_book(enc_book);
+  impl::decoding_table dec_table(dec_book);
   impl::buffered_reader reader(from);
   if (reader.eof()) {
     throw std::invalid_argument("incorrect data format: "
                                 "the data size byte expected, but nothing found");
   }
   unsigned char last_size = (static_cast<unsigned char>(reader.read()) % CHAR_BIT) + 1;
-  decode_data(reader, to, dec_book, last_size);
+  decode_data(reader, to, dec_table, last_size);
   if (!to) {
     throw std::runtime_error("unexpected error while writing data");
   }
@@ -37,6 +37,18 @@ std::string dataset::linear_freq() {
   return res;
 }
 
+std::string dataset::fib_freq() {
+  std::string res;
+  size_t prev = 0;
+  size_t cur = 1;
+  for (size_t i = 0; i < FIB_FREQ_CHAR_CNT; ++i) {
+    res.append(cur, static_cast<char>(i));
+    cur += prev;
+    prev = cur - prev;
+  }
+  return res;
+}
+
 std::vector<std::string> dataset::generate_data_to_encode() {
   std::vector<std::string> dataset;
   dataset.push_back("");
@@ -44,6 +56,7 @@ std::vector<std::string> dataset::generate_data_to_encode() {
   dataset.push_back(equal_freq());
   dataset.push_back(linear_freq());
   dataset.push_back(exp_freq());
+  dataset.push_back(fib_freq());
   return dataset;
 }
 
@@ -142,6 +155,17 @@ std::vector<std::pair<std::stringstream, std::string>> dataset::generate_correct
     in << '\xff' << 'A';
     dataset.emplace_back(std::move(in), "A");
   }
+  {
+    // the code of i is i ones and a zero, the code of 255 is 255 ones
+    std::stringstream in;
+    for (size_t i = 0; i < 255; ++i) {
+      in << static_cast<char>(i + 1);
+    }
+    in << '\xff' << '\x7';
+    add(in, '\xff', 31);
+    in << '\xfe';
+    dataset.emplace_back(std::move(in), std::string("\xff\x0", 2));
+  }
   return dataset;
 }
 
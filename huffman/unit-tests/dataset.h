@@ -18,6 +18,10 @@ std::string exp_freq();
 const size_t LINEAR_FREQ_CHAR_CNT = 256;
 std::string linear_freq();
 
+// codes up to FIB_FREQ_CHAR_CNT - 1 bits long
+const size_t FIB_FREQ_CHAR_CNT = 25;
+std::string fib_freq();
+
 std::vector<std::string> generate_data_to_encode();
 std::vector<std::stringstream> generate_incorrect_data_to_decode();
 std::vector<std::pair<std::stringstream, std::string>> generate_correct_data_to_decode();
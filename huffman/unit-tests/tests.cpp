@@ -1,4 +1,5 @@
 #include "../huffman-lib/bit_sequence.h"
+#include "../huffman-lib/encoding_table.h"
 #include "../huffman-lib/util.h"
 #include "dataset.h"
 
@@ -190,6 +191,50 @@ TEST(utils, encoding_book_exp_frequency) {
   }
 }
 
+TEST(utils, encoding_book_fib_frequency) {
+  std::stringstream ss(dataset::fib_freq());
+  huffman::impl::buffered_reader reader(ss);
+  auto hist = huffman::impl::calc_histogram(reader);
+  huffman::impl::encoding_book eb = huffman::impl::build_encoding_book(hist);
+  EXPECT_EQ(eb[0].size(), dataset::FIB_FREQ_CHAR_CNT - 1);
+  for (size_t i = 1; i < dataset::FIB_FREQ_CHAR_CNT; ++i) {
+    EXPECT_EQ(eb[i].size(), dataset::FIB_FREQ_CHAR_CNT - i);
+  }
+}
+
+TEST(utils, encoding_table) {
+  for (auto& s : dataset::generate_data_to_encode()) {
+    std::stringstream ss(s);
+    huffman::impl::buffered_reader reader(ss);
+    auto hist = huffman::impl::calc_histogram(reader);
+    huffman::impl::encoding_book eb = huffman::impl::build_encoding_book(hist);
+    huffman::impl::encoding_table et(eb);
+    for (size_t i = 0; i < huffman::impl::ENCODING_VALUE_COUNT; ++i) {
+      auto e = et[i];
+      EXPECT_EQ(e.len, eb[i].size());
+      if (e.len) {
+        EXPECT_EQ(huffman::impl::bit_sequence(e.code >> (UINT64_WIDTH - e.len), e.len), eb[i]);
+        EXPECT_EQ(e.code << e.len, 0);
+      }
+    }
+  }
+}
+
+TEST(utils, encoding_table_long_codes) {
+  huffman::impl::histogram hist;
+  hist.fill(0);
+  uint64_t prev = 0;
+  uint64_t cur = 1;
+  for (size_t i = 0; i <= huffman::impl::encoding_table::MAX_CODE_SIZE + 1; ++i) {
+    hist[i] = cur;
+    cur += prev;
+    prev = cur - prev;
+  }
+  auto eb = huffman::impl::build_encoding_book(hist);
+  EXPECT_GT(eb[0].size(), huffman::impl::encoding_table::MAX_CODE_SIZE);
+  EXPECT_THROW(huffman::impl::encoding_table et(eb), std::runtime_error);
+}
+
 TEST(utils, correct_format) {
   for (auto& s : dataset::generate_correct_data_to_decode()) {
     std::stringstream& in = s.first;